@@ -0,0 +1,54 @@
+/* 2452214 霍宇哲 大数据 */
+#include "Arena.h"
+#include <algorithm>
+#include <cstdint>
+
+Arena::Arena(size_t blockSize) : lanes(1, Lane()), block_size(blockSize), reserved(0) {}
+
+void Arena::setLanes(int count) {
+	lanes.resize(max(1, count), Lane());
+}
+
+char* Arena::newBlock(size_t size) {
+	lock_guard<mutex> lock(mtx);
+	blocks.emplace_back(new char[size]);
+	reserved += size;
+	return blocks.back().get();
+}
+
+void* Arena::allocate(size_t bytes, size_t align, int lane) {
+	Lane& l = lanes[lane];
+	uintptr_t p = ((uintptr_t)l.cursor + align - 1) & ~(uintptr_t)(align - 1);
+	if (!l.cursor || p + bytes > (uintptr_t)l.limit) {
+		// 当前块放不下：开一个新块（超大的请求单独占一块）
+		size_t size = max(block_size, bytes + align);
+		l.cursor = newBlock(size);
+		l.limit = l.cursor + size;
+		p = ((uintptr_t)l.cursor + align - 1) & ~(uintptr_t)(align - 1);
+	}
+
+	l.cursor = (char*)(p + bytes);
+	return (void*)p;
+}
+
+void Arena::clear() {
+	lock_guard<mutex> lock(mtx);
+	blocks.clear();
+	for (Lane& l : lanes) {
+		l.cursor = nullptr;
+		l.limit = nullptr;
+	}
+	reserved = 0;
+}
+
+void Arena::swap(Arena& other) {
+	if (this == &other)
+		return;
+	lock(mtx, other.mtx);
+	lock_guard<mutex> lockThis(mtx, adopt_lock);
+	lock_guard<mutex> lockOther(other.mtx, adopt_lock);
+	blocks.swap(other.blocks);
+	lanes.swap(other.lanes);
+	std::swap(block_size, other.block_size);
+	std::swap(reserved, other.reserved);
+}
\ No newline at end of file
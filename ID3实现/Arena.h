@@ -0,0 +1,68 @@
+/* 2452214 霍宇哲 大数据 */
+#pragma once
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <cstddef>
+
+using namespace std;
+
+// 按块批量申请内存的分配器：对象在块内连续存放，不单独释放，clear 时整块归还
+// 只能存放平凡析构的对象（不会调用析构函数）
+// 分配分成若干条通道，每条通道有自己的当前块：多个线程各用一条通道同时分配时互不干扰，
+// 只有通道的当前块用完、要开新块时才加锁
+class Arena {
+public:
+	explicit Arena(size_t blockSize = 64 * 1024);
+
+	// 设置通道数（默认 1），只能在没有线程正在分配时调用；已分配的对象不受影响
+	void setLanes(int lanes);
+	int laneCount() const { return (int)lanes.size(); }
+
+	// 在通道 lane 上分配 bytes 字节，按 align 对齐；同一时刻一条通道只能由一个线程使用
+	void* allocate(size_t bytes, size_t align, int lane = 0);
+
+	template <class T>
+	T* create(int lane = 0) {
+		return new (allocate(sizeof(T), alignof(T), lane)) T();
+	}
+
+	// 分配 count 个值初始化的 T
+	template <class T>
+	T* createArray(size_t count, int lane = 0) {
+		T* p = (T*)allocate(sizeof(T) * count, alignof(T), lane);
+		for (size_t i = 0; i < count; ++i)
+			new (p + i) T();
+		return p;
+	}
+
+	// 释放全部对象
+	void clear();
+
+	// 与 other 交换全部的块和通道（把对象整理到新 Arena 后换回来），不能与分配同时进行
+	void swap(Arena& other);
+
+	// 已申请的块的总字节数
+	size_t bytesReserved() const { return reserved; }
+
+private:
+	// 一条通道正在使用的块，填充到 64 字节，避免相邻通道落在同一缓存行上
+	struct Lane {
+		char* cursor;      // 当前块中下一个空闲字节
+		char* limit;       // 当前块的末尾
+		char padding[64 - 2 * sizeof(char*)];
+	};
+
+	mutex mtx;                         // 保护 blocks 和 reserved
+	vector<unique_ptr<char[]>> blocks;
+	vector<Lane> lanes;
+	size_t block_size;
+	size_t reserved;
+
+	// 申请一个至少 size 字节的新块（加锁）
+	char* newBlock(size_t size);
+
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+};
\ No newline at end of file
@@ -0,0 +1,91 @@
+/* 2452214 霍宇哲 大数据 */
+#pragma once
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include "Dataset.h"
+
+using namespace std;
+
+// 二进制文件（数据集缓存、模型文件）共用的读写工具，数值一律按本机字节序（小端）存放
+
+inline unsigned long long alignTo8(unsigned long long offset) {
+	return (offset + 7) & ~7ULL;
+}
+
+inline void writeU32(FILE* f, unsigned int v) {
+	fwrite(&v, sizeof(v), 1, f);
+}
+
+inline void writeU64(FILE* f, unsigned long long v) {
+	fwrite(&v, sizeof(v), 1, f);
+}
+
+// 字符串写成 u32 长度 + 字节
+inline void writeString(FILE* f, const string& s) {
+	writeU32(f, (unsigned int)s.size());
+	fwrite(s.data(), 1, s.size(), f);
+}
+
+inline void writePadding(FILE* f, unsigned long long from, unsigned long long to) {
+	static const char zeros[8] = { 0 };
+	fwrite(zeros, 1, (size_t)(to - from), f);
+}
+
+// 64 位的文件定位（大于 2GB 的文件也能定位），失败返回 false
+inline bool seekFile(FILE* f, unsigned long long offset) {
+#ifdef _WIN32
+	return _fseeki64(f, (long long)offset, SEEK_SET) == 0;
+#else
+	return fseeko(f, (off_t)offset, SEEK_SET) == 0;
+#endif
+}
+
+// 文件的总长度，失败返回 false（会移动文件位置）
+inline bool fileLength(FILE* f, unsigned long long& length) {
+#ifdef _WIN32
+	if (_fseeki64(f, 0, SEEK_END) != 0)
+		return false;
+	long long pos = _ftelli64(f);
+#else
+	if (fseeko(f, 0, SEEK_END) != 0)
+		return false;
+	long long pos = (long long)ftello(f);
+#endif
+	if (pos < 0)
+		return false;
+	length = (unsigned long long)pos;
+	return true;
+}
+
+// 在映射的文件内容上带越界检查地顺序读取，任何越界都返回 false
+class BinaryCursor {
+public:
+	BinaryCursor(const char* base, size_t size, unsigned long long offset) : base(base), size(size), pos(offset) {}
+
+	bool readU32(unsigned int& v) { return read(&v, sizeof(v)); }
+	bool readU64(unsigned long long& v) { return read(&v, sizeof(v)); }
+
+	// 读取 u32 长度 + 字节，结果直接指向文件内容
+	bool readRef(StringRef& ref) {
+		unsigned int len;
+		if (!readU32(len) || pos + len > size)
+			return false;
+		ref = StringRef(base + pos, len);
+		pos += len;
+		return true;
+	}
+
+private:
+	const char* base;
+	size_t size;
+	unsigned long long pos;
+
+	bool read(void* dst, size_t n) {
+		if (pos + n > size)
+			return false;
+		memcpy(dst, base + pos, n);
+		pos += n;
+		return true;
+	}
+};
\ No newline at end of file
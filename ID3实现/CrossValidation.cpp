@@ -0,0 +1,122 @@
+/* 2452214 霍宇哲 大数据 */
+#include "CrossValidation.h"
+#include "ThreadPool.h"
+#include "Random.h"
+#include <iostream>
+#include <cmath>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <algorithm>
+
+vector<int> assignFolds(const Dataset& data, int targetIndex, const CrossValidationOptions& options, int repeat) {
+	const int n = data.numRows();
+	const int folds = max(1, options.folds);
+
+	// 打乱行号（Fisher-Yates）
+	SplitMix64 rng(((uint64_t)options.seed << 32) ^ ((uint64_t)repeat * 0x9E3779B97F4A7C15ULL));
+	vector<int> order(n);
+	for (int i = 0; i < n; ++i)
+		order[i] = i;
+	for (int i = n - 1; i > 0; --i)
+		swap(order[i], order[rng.below(i + 1)]);
+
+	// 分层时按类别稳定地排在一起（计数排序），再依次轮流发到各折，计数跨类别连续，各折大小最多差 1
+	if (options.stratified) {
+		const vector<int>& labels = data.column(targetIndex);
+		vector<int> start(data.dictionary(targetIndex).size() + 1, 0);
+		for (int r : order)
+			start[labels[r] + 1]++;
+		for (size_t c = 1; c < start.size(); ++c)
+			start[c] += start[c - 1];
+		vector<int> grouped(n);
+		for (int r : order)
+			grouped[start[labels[r]]++] = r;
+		order.swap(grouped);
+	}
+
+	vector<int> foldOf(n);
+	for (int i = 0; i < n; ++i)
+		foldOf[order[i]] = i % folds;
+	return foldOf;
+}
+
+CrossValidationResult crossValidate(const Dataset& data, const string& target, const CrossValidationOptions& options,
+	const function<void(ID3&)>& configure) {
+	CrossValidationResult result;
+	const int targetIndex = data.findAttribute(target);
+	if (targetIndex < 0) {
+		cerr << "错误: 找不到目标列 " << target << endl;
+		return result;
+	}
+
+	const int folds = max(1, options.folds);
+	const int repeats = max(1, options.repeats);
+	const int numClasses = data.dictionary(targetIndex).size();
+	const int tasks = folds * repeats;
+	result.numClasses = numClasses;
+	result.folds.resize(tasks);
+	vector<vector<long long>> confusions(tasks, vector<long long>((size_t)numClasses * numClasses, 0));
+
+	// 第 t 个任务是第 t / folds 次重复的第 t % folds 折，各任务只写自己的结果
+	auto runFold = [&](int t) {
+		FoldResult& fold = result.folds[t];
+		fold.repeat = t / folds;
+		fold.fold = t % folds;
+
+		vector<int> foldOf = assignFolds(data, targetIndex, options, fold.repeat);
+		vector<int> trainRows, testRows;
+		for (int r = 0; r < data.numRows(); ++r)
+			(foldOf[r] == fold.fold ? testRows : trainRows).push_back(r);
+		vector<int>().swap(foldOf);
+
+		ID3 tree;
+		if (configure)
+			configure(tree);
+		auto start = chrono::steady_clock::now();
+		tree.trainOnRows(data, target, trainRows);
+		fold.trainSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		fold.treeNodes = tree.nodeCount();
+		fold.trainRows = (int)trainRows.size();
+		fold.testRows = (int)testRows.size();
+
+		// 模型的字典就是 data 的字典，测试行直接按行号预测
+		const vector<int>& labels = data.column(targetIndex);
+		fold.predicted = 0;
+		fold.correct = 0;
+		for (int r : testRows) {
+			int label = tree.predictRow(data, r);
+			if (label < 0)
+				continue;
+			fold.predicted++;
+			if (label == labels[r])
+				fold.correct++;
+			confusions[t][(size_t)labels[r] * numClasses + label]++;
+		}
+		fold.accuracy = fold.predicted > 0 ? (double)fold.correct / fold.predicted : 0.0;
+	};
+
+	int threads = options.threads <= 0 ? (int)thread::hardware_concurrency() : options.threads;
+	if (threads > 1 && tasks > 1) {
+		ThreadPool pool(min(threads, tasks));
+		pool.parallelFor(tasks, runFold);
+	}
+	else {
+		for (int t = 0; t < tasks; ++t)
+			runFold(t);
+	}
+
+	// 按任务顺序汇总，结果与线程数无关
+	result.confusion.assign((size_t)numClasses * numClasses, 0);
+	double sum = 0, sumSquares = 0;
+	for (int t = 0; t < tasks; ++t) {
+		for (size_t i = 0; i < result.confusion.size(); ++i)
+			result.confusion[i] += confusions[t][i];
+		result.unknown += result.folds[t].testRows - result.folds[t].predicted;
+		sum += result.folds[t].accuracy;
+		sumSquares += result.folds[t].accuracy * result.folds[t].accuracy;
+	}
+	result.meanAccuracy = sum / tasks;
+	result.stdAccuracy = sqrt(max(0.0, sumSquares / tasks - result.meanAccuracy * result.meanAccuracy));
+	return result;
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+/* 2452214 霍宇哲 大数据 */
+#pragma once
+#include <vector>
+#include <string>
+#include <functional>
+#include "Dataset.h"
+#include "ID3.h"
+
+using namespace std;
+
+// 交叉验证的参数
+struct CrossValidationOptions {
+	int folds;
+	int repeats;       // 重复次数，每次重新打乱后划分
+	bool stratified;   // 分层：每一折中各类别的比例与全体相同
+	unsigned int seed;
+	int threads;       // 同时运行的折数（0 表示使用全部硬件线程），不影响结果
+
+	CrossValidationOptions() : folds(10), repeats(1), stratified(true), seed(42), threads(1) {}
+};
+
+// 一折的结果
+struct FoldResult {
+	int repeat;
+	int fold;
+	int trainRows;
+	int testRows;
+	int predicted;             // 能给出预测的测试行数（其余遇到了没见过的取值）
+	int correct;
+	double accuracy;           // correct / predicted
+	int treeNodes;
+	double trainSeconds;
+};
+
+// 交叉验证的汇总结果
+struct CrossValidationResult {
+	vector<FoldResult> folds;          // 按 (repeat, fold) 顺序
+	int numClasses;
+	vector<long long> confusion;       // 所有折累加的混淆矩阵，confusion[实际 * numClasses + 预测]
+	long long unknown;                 // 无法预测的测试行数
+	double meanAccuracy;               // 各折准确率的平均值
+	double stdAccuracy;                // 各折准确率的标准差
+
+	CrossValidationResult() : numClasses(0), unknown(0), meanAccuracy(0), stdAccuracy(0) {}
+
+	long long confusionAt(int actual, int predicted) const { return confusion[(size_t)actual * numClasses + predicted]; }
+};
+
+// 按选项划分第 repeat 次重复的各折：返回每行所属的折号
+// 只取决于 seed、repeat 和各行的类别，可以在任意线程里重新计算，不需要为每一折保存行号
+vector<int> assignFolds(const Dataset& data, int targetIndex, const CrossValidationOptions& options, int repeat);
+
+// k 折交叉验证：所有折共享同一个编码数据集，每一折只是训练行号和测试行号两个列表，
+// 用 ID3::trainOnRows 训练、ID3::predictRow 预测，数据不复制；同时运行的折各自占用一个线程
+// 每一折的预测与用 select 复制出训练集和测试集、训练后在 encodeBatch 的结果上预测相同：只在测试折里出现的分类取值无法预测
+// configure 在每一折训练前调用，可以设置超参数（例如 setFeatureSubset）；目标列不存在时返回空结果
+CrossValidationResult crossValidate(const Dataset& data, const string& target, const CrossValidationOptions& options,
+	const function<void(ID3&)>& configure = nullptr);
\ No newline at end of file
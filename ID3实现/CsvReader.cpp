@@ -0,0 +1,202 @@
+/* 2452214 霍宇哲 大数据 */
+#include "CsvReader.h"
+#include "MappedFile.h"
+#include <iostream>
+#include <cstring>
+#include <cstdio>
+#include <future>
+#include <sys/stat.h>
+
+// 去掉字段两端成对的引号
+static StringRef stripQuotes(const char* begin, const char* end) {
+	size_t size = end - begin;
+	if (size > 0) {
+		char first = begin[0];
+		char last = end[-1];
+		if ((first == '"' && last == '"') || (first == '\'' && last == '\'')) {
+			if (size == 1)
+				return StringRef(begin, 0);
+			return StringRef(begin + 1, size - 2);
+		}
+	}
+	return StringRef(begin, size);
+}
+
+void splitFields(const char* begin, const char* end, char delimiter, vector<StringRef>& fields) {
+	fields.clear();
+
+	// 兼容 Windows 换行
+	if (end > begin && end[-1] == '\r')
+		end--;
+
+	const char* p = begin;
+	while (p < end) {
+		const char* d = (const char*)memchr(p, delimiter, end - p);
+		if (!d)
+			d = end;
+		fields.push_back(stripQuotes(p, d));
+		p = d + 1;
+	}
+}
+
+// 找到下一行的结尾（换行符的位置，最后一行没有换行符时为文件末尾）
+static const char* findLineEnd(const char* p, const char* end) {
+	const char* eol = (const char*)memchr(p, '\n', end - p);
+	return eol ? eol : end;
+}
+
+// 逐行解析的状态：第一行作为属性名，之后每行编码追加到 data
+class CsvLineParser {
+public:
+	CsvLineParser(char delimiter, Dataset& data) : delimiter(delimiter), data(data), lineCount(0) {}
+
+	void parseLine(const char* begin, const char* end) {
+		lineCount++;
+		splitFields(begin, end, delimiter, fields);
+
+		// 读取属性名（第一行）
+		if (lineCount == 1) {
+			vector<string> attributeNames;
+			for (const StringRef& f : fields)
+				attributeNames.emplace_back(f.data, f.size);
+			data = Dataset(attributeNames);
+			return;
+		}
+
+		// 检查列数是否匹配
+		size_t expected = data.numAttributes();
+		if (fields.size() != expected) {
+			cerr << "警告: 第 " << lineCount << " 行有 " << fields.size()
+				<< " 列，但期望 " << expected << " 列" << endl;
+			cerr << "行内容: " << string(begin, end) << endl;
+
+			// 尝试修复：列数不足填充空值，列数过多截断
+			fields.resize(expected, StringRef("", 0));
+		}
+
+		data.appendRow(fields);
+	}
+
+	// 没有任何内容的文件也要得到一个空数据集
+	void finish() {
+		if (lineCount == 0)
+			data = Dataset();
+		// 编码顺序与字符串顺序一致
+		data.sortDictionaries();
+	}
+
+private:
+	char delimiter;
+	Dataset& data;
+	int lineCount;
+	vector<StringRef> fields; // 各行复用
+};
+
+bool loadCsv(const string& filename, char delimiter, Dataset& data) {
+	MappedFile file;
+	if (!file.open(filename))
+		return false;
+
+	const char* p = file.data();
+	const char* end = p + file.size();
+	CsvLineParser parser(delimiter, data);
+
+	while (p < end) {
+		const char* eol = findLineEnd(p, end);
+		parser.parseLine(p, eol);
+		p = eol + 1;
+	}
+
+	parser.finish();
+	return true;
+}
+
+// 文件大小（用于进度回调），失败返回 0
+static size_t fileSize(const string& filename) {
+#ifdef _WIN32
+	struct _stat64 st;
+	if (_stat64(filename.c_str(), &st) != 0)
+		return 0;
+#else
+	struct stat st;
+	if (stat(filename.c_str(), &st) != 0)
+		return 0;
+#endif
+	return (size_t)st.st_size;
+}
+
+bool loadCsvStreaming(const string& filename, char delimiter, Dataset& data, const CsvStreamOptions& options) {
+	FILE* file = fopen(filename.c_str(), "rb");
+	if (!file)
+		return false;
+
+	const size_t chunkSize = max((size_t)1, options.chunkSize);
+	const size_t totalBytes = fileSize(filename);
+	vector<char> buffers[2] = { vector<char>(chunkSize), vector<char>(chunkSize) };
+	string carry; // 跨越块边界、尚未读到换行符的半行
+	CsvLineParser parser(delimiter, data);
+	size_t bytesDone = 0;
+	bool withinLimit = true;
+
+	int current = 0;
+	size_t length = fread(buffers[current].data(), 1, chunkSize, file);
+	while (length > 0) {
+		// 后台读取下一块
+		vector<char>& nextBuffer = buffers[1 - current];
+		future<size_t> pending = async(launch::async, [&nextBuffer, file, chunkSize]() {
+			return fread(nextBuffer.data(), 1, chunkSize, file);
+		});
+
+		const char* p = buffers[current].data();
+		const char* end = p + length;
+
+		// 先补完上一块留下的半行
+		if (!carry.empty()) {
+			const char* eol = findLineEnd(p, end);
+			carry.append(p, eol);
+			if (eol < end) {
+				parser.parseLine(carry.data(), carry.data() + carry.size());
+				carry.clear();
+				p = eol + 1;
+			}
+			else {
+				p = end;
+			}
+		}
+
+		// 块内完整的行直接在缓冲区上切分，最后不完整的一行留到下一块
+		while (p < end) {
+			const char* eol = (const char*)memchr(p, '\n', end - p);
+			if (!eol) {
+				carry.assign(p, end);
+				break;
+			}
+			parser.parseLine(p, eol);
+			p = eol + 1;
+		}
+
+		bytesDone += length;
+		size_t nextLength = pending.get();
+
+		if (options.progress)
+			options.progress(bytesDone, totalBytes, data.numRows());
+
+		if (options.memoryLimit > 0 && data.memoryUsage() > options.memoryLimit) {
+			cerr << "错误: 编码后的数据超过内存上限 " << options.memoryLimit << " 字节，已读取 "
+				<< bytesDone << " 字节、" << data.numRows() << " 行" << endl;
+			withinLimit = false;
+			break;
+		}
+
+		length = nextLength;
+		current = 1 - current;
+	}
+
+	// 文件最后一行没有换行符
+	if (withinLimit && !carry.empty())
+		parser.parseLine(carry.data(), carry.data() + carry.size());
+
+	fclose(file);
+	parser.finish();
+	return withinLimit;
+}
\ No newline at end of file
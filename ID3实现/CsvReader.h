@@ -0,0 +1,33 @@
+/* 2452214 霍宇哲 大数据 */
+#pragma once
+#include <vector>
+#include <string>
+#include <functional>
+#include "Dataset.h"
+
+using namespace std;
+
+// 按分隔符切分一行 [begin, end)，字段直接指向原缓冲区，不分配内存
+// 规则与逐行 getline 切分一致：末尾的空字段不计入；两端成对的双引号或单引号会被去掉
+void splitFields(const char* begin, const char* end, char delimiter, vector<StringRef>& fields);
+
+// 以内存映射方式加载 CSV：第一行是属性名，其余每行在映射的文件内容上原地切分后直接编码追加到 data
+// 行和字段边界用 memchr 查找（C 运行库中为向量化实现），整个过程不为单元格分配字符串
+// 列数不符的行会在 cerr 给出警告，并补空值或截断；文件无法打开时返回 false
+bool loadCsv(const string& filename, char delimiter, Dataset& data);
+
+// 流式加载的选项
+struct CsvStreamOptions {
+	size_t chunkSize;    // 每次从文件读取的字节数
+	size_t memoryLimit;  // 编码后数据集（编码列 + 字典）允许占用的内存上限（字节），0 表示不限制
+
+	// 每处理完一个块调用一次：已处理字节数、文件总字节数、已编码的行数
+	function<void(size_t bytesDone, size_t bytesTotal, int rows)> progress;
+
+	CsvStreamOptions() : chunkSize(4 << 20), memoryLimit(0) {}
+};
+
+// 流式加载 CSV：按固定大小的块顺序读取文件，逐块切分并编码追加到 data，不需要把整个文件放进内存
+// 两个块缓冲区交替使用，后台线程读取下一块的同时当前线程编码这一块
+// 内存占用约为 2 个块 + 编码后的数据集；超过 memoryLimit 时停止读取并返回 false（data 中保留已编码的部分）
+bool loadCsvStreaming(const string& filename, char delimiter, Dataset& data, const CsvStreamOptions& options = CsvStreamOptions());
\ No newline at end of file
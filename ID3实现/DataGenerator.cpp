@@ -0,0 +1,276 @@
+/* 2452214 霍宇哲 大数据 */
+#include "DataGenerator.h"
+#include "ThreadPool.h"
+#include "DatasetCache.h"
+#include <iostream>
+#include <cstdio>
+#include <algorithm>
+#include <climits>
+
+DataGenerator::DataGenerator(const GeneratorOptions& options) : options(options) {
+	int numFeatures = options.cardinalities.empty() ? options.attributes : (int)options.cardinalities.size();
+	for (int j = 0; j < numFeatures; ++j) {
+		int cardinality = options.cardinalities.empty() ? options.cardinality : options.cardinalities[j];
+		attr_name.push_back("a" + to_string(j));
+		values.emplace_back();
+		for (int v = 0; v < max(1, cardinality); ++v)
+			values.back().push_back("v" + to_string(v));
+	}
+
+	target_index = numFeatures;
+	attr_name.push_back("label");
+	values.emplace_back();
+	for (int c = 0; c < max(1, options.classes); ++c)
+		values.back().push_back("c" + to_string(c));
+
+	plantTree();
+}
+
+DataGenerator::DataGenerator(const GeneratorOptions& options, const Dataset& sample, const string& target)
+	: options(options), attr_name(sample.attributeNames()), target_index(sample.findAttribute(target)) {
+	if (target_index < 0 || sample.numRows() == 0) {
+		cerr << "错误: 模板数据集为空或没有目标列 " << target << endl;
+		attr_name.clear();
+		target_index = -1;
+		return;
+	}
+
+	for (int j = 0; j < sample.numAttributes(); ++j) {
+		values.push_back(sample.dictionary(j).allValues());
+		sample_columns.push_back(sample.column(j));
+	}
+	this->options.classes = (int)values[target_index].size();
+	plantTree();
+}
+
+void DataGenerator::plantTree() {
+	SplitMix64 rng(options.seed);
+	vector<bool> used(attr_name.size(), false);
+	used[target_index] = true;
+	planted.assign(1, FlatNode());
+	plantNode(0, 0, used, rng);
+}
+
+// 递归植入：每个内部节点随机选一个路径上没用过的属性，每个取值一个子节点，叶子的类别随机
+void DataGenerator::plantNode(int index, int depth, vector<bool>& used, SplitMix64& rng) {
+	vector<int> candidates;
+	for (size_t j = 0; j < used.size(); ++j)
+		if (!used[j])
+			candidates.push_back((int)j);
+
+	int attr = candidates.empty() ? -1 : candidates[rng.below((int)candidates.size())];
+	if (depth >= options.plantedDepth || attr < 0 ||
+		planted.size() + values[attr].size() > (size_t)MAX_PLANTED_NODES) {
+		planted[index].attr = -1;
+		planted[index].next = rng.below(options.classes);
+		return;
+	}
+
+	int first = (int)planted.size();
+	planted.resize(first + values[attr].size());
+	planted[index].attr = attr;
+	planted[index].next = first;
+
+	used[attr] = true;
+	for (int v = 0; v < (int)values[attr].size(); ++v)
+		plantNode(first + v, depth + 1, used, rng);
+	used[attr] = false;
+}
+
+int DataGenerator::plantedLabel(const int* codes) const {
+	const FlatNode* node = planted.data();
+	while (node->attr >= 0)
+		node = planted.data() + node->next + codes[node->attr];
+	return node->next;
+}
+
+int DataGenerator::generateChunk(long long chunk, vector<int>& codes) const {
+	const int cols = (int)attr_name.size();
+	const int rows = chunkRows(chunk);
+	codes.resize((size_t)rows * cols);
+
+	SplitMix64 rng(((uint64_t)options.seed << 32) ^ ((uint64_t)chunk * 0xD1B54A32D192ED03ULL));
+	const int sampleRows = sample_columns.empty() ? 0 : (int)sample_columns[0].size();
+
+	for (int r = 0; r < rows; ++r) {
+		int* row = codes.data() + (size_t)r * cols;
+		for (int j = 0; j < cols; ++j) {
+			if (j == target_index)
+				continue;
+			row[j] = sampleRows > 0 ? sample_columns[j][rng.below(sampleRows)] : rng.below((int)values[j].size());
+		}
+
+		int label = plantedLabel(row);
+		if (options.labelNoise > 0 && rng.unit() < options.labelNoise)
+			label = rng.below(options.classes);
+		row[target_index] = label;
+	}
+	return rows;
+}
+
+void DataGenerator::renderChunk(const vector<int>& codes, int rows, string& text) const {
+	const int cols = (int)attr_name.size();
+	text.clear();
+	for (int r = 0; r < rows; ++r) {
+		const int* row = codes.data() + (size_t)r * cols;
+		for (int j = 0; j < cols; ++j) {
+			if (j > 0)
+				text += options.delimiter;
+			text += values[j][row[j]];
+		}
+		text += '\n';
+	}
+}
+
+int DataGenerator::chunkRows(long long chunk) const {
+	return (int)min<long long>(GENERATOR_CHUNK_ROWS, options.rows - chunk * GENERATOR_CHUNK_ROWS);
+}
+
+bool DataGenerator::runBatches(const function<void(long long, int)>& work, const function<bool(long long, int)>& flush,
+	const function<void(long long)>& progress) const {
+	// 每批并行生成 batch 块，再按顺序写盘
+	const int threads = max(1, options.threads);
+	const int batch = threads * 2;
+	unique_ptr<ThreadPool> pool;
+	if (threads > 1)
+		pool.reset(new ThreadPool(threads));
+
+	const long long numChunks = (options.rows + GENERATOR_CHUNK_ROWS - 1) / GENERATOR_CHUNK_ROWS;
+	long long rowsDone = 0;
+
+	for (long long first = 0; first < numChunks; first += batch) {
+		int count = (int)min<long long>(batch, numChunks - first);
+		auto task = [&](int i) { work(first + i, i); };
+		if (pool)
+			pool->parallelFor(count, task);
+		else
+			for (int i = 0; i < count; ++i)
+				task(i);
+
+		if (!flush(first, count))
+			return false;
+		for (int i = 0; i < count; ++i)
+			rowsDone += chunkRows(first + i);
+		if (progress)
+			progress(rowsDone);
+	}
+	return true;
+}
+
+bool DataGenerator::writeCsv(const string& filename, const function<void(long long)>& progress) const {
+	if (attr_name.empty())
+		return false;
+
+	FILE* file = fopen(filename.c_str(), "wb");
+	if (!file) {
+		cerr << "错误: 无法写入文件 " << filename << endl;
+		return false;
+	}
+
+	string header;
+	for (size_t j = 0; j < attr_name.size(); ++j) {
+		if (j > 0)
+			header += options.delimiter;
+		header += attr_name[j];
+	}
+	header += '\n';
+	fwrite(header.data(), 1, header.size(), file);
+
+	const int batch = max(1, options.threads) * 2;
+	vector<vector<int>> codes(batch);
+	vector<string> texts(batch);
+	runBatches([&](long long chunk, int i) {
+		int rows = generateChunk(chunk, codes[i]);
+		renderChunk(codes[i], rows, texts[i]);
+	}, [&](long long, int count) {
+		for (int i = 0; i < count; ++i)
+			fwrite(texts[i].data(), 1, texts[i].size(), file);
+		return true;
+	}, progress);
+
+	bool ok = !ferror(file);
+	fclose(file);
+	return ok;
+}
+
+bool DataGenerator::writeCache(const string& filename, const function<void(long long)>& progress) const {
+	if (attr_name.empty())
+		return false;
+	if (options.rows > INT_MAX) {
+		cerr << "错误: 缓存文件最多 " << INT_MAX << " 行" << endl;
+		return false;
+	}
+
+	// 字典按字符串排序，remap[j][v] 是生成编码 v 在缓存字典中的编码
+	const int cols = (int)attr_name.size();
+	vector<ValueDictionary> dicts(cols);
+	vector<vector<int>> remap(cols);
+	for (int j = 0; j < cols; ++j) {
+		vector<string> sorted = values[j];
+		sort(sorted.begin(), sorted.end());
+		for (const string& v : sorted)
+			dicts[j].intern(v);
+		for (const string& v : values[j])
+			remap[j].push_back(dicts[j].find(v));
+	}
+
+	DatasetCacheWriter writer;
+	if (!writer.open(filename, attr_name, dicts, (int)options.rows)) {
+		writer.close();
+		return false;
+	}
+
+	// 每块转成列式再写到各列的数据区
+	const int batch = max(1, options.threads) * 2;
+	vector<vector<int>> codes(batch);
+	vector<vector<vector<int>>> columns(batch, vector<vector<int>>(cols));
+	runBatches([&](long long chunk, int i) {
+		int rows = generateChunk(chunk, codes[i]);
+		for (int j = 0; j < cols; ++j) {
+			columns[i][j].resize(rows);
+			for (int r = 0; r < rows; ++r)
+				columns[i][j][r] = remap[j][codes[i][(size_t)r * cols + j]];
+		}
+	}, [&](long long first, int count) {
+		for (int i = 0; i < count; ++i)
+			for (int j = 0; j < cols; ++j)
+				if (!writer.writeRows(j, (int)((first + i) * GENERATOR_CHUNK_ROWS), columns[i][j].data(), chunkRows(first + i)))
+					return false;
+		return true;
+	}, progress);
+
+	return writer.close();
+}
+
+Dataset DataGenerator::generate() const {
+	Dataset data(attr_name);
+	if (attr_name.empty())
+		return data;
+
+	const int cols = (int)attr_name.size();
+	vector<vector<int>> columns(cols);
+	vector<int> codes;
+	const long long numChunks = (options.rows + GENERATOR_CHUNK_ROWS - 1) / GENERATOR_CHUNK_ROWS;
+	for (long long chunk = 0; chunk < numChunks; ++chunk) {
+		int rows = generateChunk(chunk, codes);
+		for (int r = 0; r < rows; ++r)
+			for (int j = 0; j < cols; ++j)
+				columns[j].push_back(codes[(size_t)r * cols + j]);
+	}
+
+	// 字典里只放实际出现过的取值，与读入 CSV 时一样
+	for (int j = 0; j < cols; ++j) {
+		ValueDictionary dict;
+		vector<int> remap(values[j].size(), -1);
+		for (int& code : columns[j]) {
+			if (remap[code] < 0)
+				remap[code] = dict.intern(values[j][code]);
+			code = remap[code];
+		}
+		data.setColumn(j, dict, move(columns[j]));
+	}
+
+	// 与读入 CSV 的结果一致：编码顺序与字符串顺序一致
+	data.sortDictionaries();
+	return data;
+}
\ No newline at end of file
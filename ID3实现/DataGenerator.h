@@ -0,0 +1,83 @@
+/* 2452214 霍宇哲 大数据 */
+#pragma once
+#include <vector>
+#include <string>
+#include <functional>
+#include "Dataset.h"
+#include "ID3.h"
+#include "Random.h"
+
+using namespace std;
+
+const int GENERATOR_CHUNK_ROWS = 1 << 16;  // 生成时每块的行数，每块有自己的随机数种子
+const int MAX_PLANTED_NODES = 1 << 20;     // 植入的树的节点数上限
+
+// 合成数据集的参数
+struct GeneratorOptions {
+	long long rows;
+	int attributes;            // 特征列数（不含类别列），使用模板时忽略
+	int cardinality;           // 每个特征的取值数，cardinalities 非空时以它为准
+	vector<int> cardinalities; // 各特征分别的取值数
+	int classes;               // 类别数，使用模板时为模板目标列的取值数
+	double labelNoise;         // 类别被替换成随机类别的比例
+	int plantedDepth;          // 植入的决策树的深度
+	unsigned int seed;
+	int threads;               // 生成用的线程数，不影响结果
+	char delimiter;
+
+	GeneratorOptions() : rows(100000), attributes(16), cardinality(8), classes(2), labelNoise(0.1), plantedDepth(4),
+		seed(42), threads(1), delimiter(';') {}
+};
+
+// 合成数据集生成器：特征独立随机生成，类别由一棵随机植入的决策树给出，再按比例加入噪声
+// 默认列名为 a0, a1, ... 和 label，取值为 v0, v1, ... 和 c0, c1, ...
+// 也可以用一个数据集作模板（例如 student-mat.csv）：列名、取值以及各列取值的频率都与模板相同，只有目标列由植入的树决定
+// 第 i 块的内容只取决于种子和 i，所以线程数、分块写盘的方式都不影响结果
+class DataGenerator {
+public:
+	explicit DataGenerator(const GeneratorOptions& options);
+	DataGenerator(const GeneratorOptions& options, const Dataset& sample, const string& target);
+
+	const vector<string>& attributeNames() const { return attr_name; }
+	int targetIndex() const { return target_index; }
+
+	// 流式写出 CSV，内存中只保留当前一批块；progress 在每批写完后收到已写的行数
+	bool writeCsv(const string& filename, const function<void(long long)>& progress = nullptr) const;
+
+	// 流式写出数据集缓存（格式见 DatasetCache.h），可以直接用于 ID3::trainOutOfCore，不经过 CSV
+	// 字典包含每列全部可能的取值（按字符串排序），所以没有出现过的取值也占一个编码，这一点与读入 CSV 不同
+	bool writeCache(const string& filename, const function<void(long long)>& progress = nullptr) const;
+
+	// 直接生成编码数据集（与读入 writeCsv 的结果相同），适合可以放进内存的规模
+	Dataset generate() const;
+
+	// 植入的树给出的类别（不含噪声），codes 是一行的编码
+	int plantedLabel(const int* codes) const;
+
+	// 植入的树（与 FlatNode 的约定相同：叶子 attr == -1，next 是类别）
+	const vector<FlatNode>& plantedTree() const { return planted; }
+
+private:
+	GeneratorOptions options;
+	vector<string> attr_name;
+	vector<vector<string>> values;        // values[j][v] 是第 j 列编码 v 的取值
+	int target_index;
+	vector<vector<int>> sample_columns;   // 模板的各列编码，按行抽样得到与模板相同的频率（无模板时为空）
+	vector<FlatNode> planted;
+
+	void plantTree();
+	void plantNode(int index, int depth, vector<bool>& used, SplitMix64& rng);
+
+	// 生成第 chunk 块，codes 按行存放（每行 attr_name.size() 个编码），返回行数
+	int generateChunk(long long chunk, vector<int>& codes) const;
+
+	// 按批并行生成：每批的块交给 work(块号, 批内序号) 并行处理，再按顺序调用 flush(批内首块号, 块数) 写盘
+	bool runBatches(const function<void(long long, int)>& work, const function<bool(long long, int)>& flush,
+		const function<void(long long)>& progress) const;
+
+	// 第 chunk 块的行数
+	int chunkRows(long long chunk) const;
+
+	// 把一块编码渲染成 CSV 文本
+	void renderChunk(const vector<int>& codes, int rows, string& text) const;
+};
\ No newline at end of file
@@ -0,0 +1,116 @@
+/* 2452214 霍宇哲 大数据 */
+#pragma once
+#include <vector>
+#include <string>
+#include <functional>
+
+using namespace std;
+
+// 指向外部缓冲区中的一段字符，不拥有内存（加载文件时直接指向文件内容，避免为每个单元格分配字符串）
+struct StringRef {
+	const char* data;
+	size_t size;
+
+	StringRef() : data(nullptr), size(0) {}
+	StringRef(const char* d, size_t n) : data(d), size(n) {}
+};
+
+// 整个字符串是一个有限的十进制数时返回 true 并写出它的值（例如 "15"、"-0.5"），空串、"NA" 等返回 false
+bool parseNumber(const string& text, double& value);
+
+// 单列的取值字典：原始字符串 <-> 整数编码
+// 字符串 -> 编码 用开放寻址哈希表实现，可以直接用 (指针, 长度) 查找，不需要先构造 string
+class ValueDictionary {
+public:
+	ValueDictionary() : string_bytes(0) {}
+
+	// 查找取值，不存在则追加，返回编码（只有新取值才会分配字符串）
+	int intern(const char* data, size_t size);
+	int intern(const string& value) { return intern(value.data(), value.size()); }
+
+	// 只查找不追加，不存在返回 -1
+	int find(const char* data, size_t size) const;
+	int find(const string& value) const { return find(value.data(), value.size()); }
+
+	const string& value(int code) const { return values[code]; }
+	const vector<string>& allValues() const { return values; }
+	int size() const { return (int)values.size(); }
+
+	// 按字符串字典序重排编码，返回 旧编码 -> 新编码 的映射
+	vector<int> sortValues();
+
+	// 估算占用的内存（字节）
+	size_t memoryUsage() const;
+
+private:
+	vector<string> values;              // 编码 -> 字符串
+	vector<int> slots;                  // 哈希槽：存编码，-1 表示空槽；容量为 2 的幂，装载率不超过 1/2
+	size_t string_bytes;                // 所有取值字符串的字符数之和
+
+	static size_t hashBytes(const char* data, size_t size);
+	void rehash(size_t capacity);
+};
+
+// 列式编码数据集：加载时把每个属性值和类别一次性编码为整数，
+// 之后的训练只比较整数，不再比较和哈希字符串
+class Dataset {
+public:
+	Dataset() : rows(0) {}
+	explicit Dataset(const vector<string>& attributeNames);
+
+	// 从按行存储的字符串表构建，完成后字典按字典序排好
+	static Dataset fromRows(const vector<vector<string>>& data, const vector<string>& attributeNames);
+
+	// 追加一行原始字符串（列数必须与属性数一致）
+	void appendRow(const vector<string>& row);
+	void appendRow(const vector<StringRef>& row);
+
+	// 追加另一个数据集的全部行，block 必须使用与本数据集相同的属性顺序和字典（例如 recode 的结果），编码原样复制
+	void appendEncoded(const Dataset& block);
+
+	// 直接设置一列的字典和编码（用于从缓存等二进制格式还原），各列的行数必须一致
+	void setColumn(int col, const ValueDictionary& dictionary, vector<int> codes);
+
+	// 按行号取出子集（例如划分训练集 / 测试集），各列字典只保留子集中出现的取值并重新排序
+	Dataset select(const vector<int>& rowIds) const;
+
+	// 按取值改写整列（例如把成绩离散化为等级）：fn 对每个不同的取值只调用一次，映射到相同结果的编码会合并
+	void mapColumn(int col, const function<string(const string&)>& fn);
+
+	// 按 旧编码 -> 新编码 的表改写整列并换上新字典（translate 覆盖旧字典的全部编码），逐行只查表
+	void remapColumn(int col, const ValueDictionary& dictionary, const vector<int>& translate);
+
+	// 把所有列的编码重排为字典序（编码顺序 = 字符串顺序，保证平票时的选择与字符串版本一致）
+	void sortDictionaries();
+
+	// 按给定的属性名和字典重新编码（例如换成模型训练时的字典）
+	// 按列名对齐；字典里没有的取值编码为 -1，本数据集缺少的列整列为 -1
+	// 每列先为每个旧编码查一次新编码，再逐行查表，不逐行比较字符串
+	// 给出 unseen 时，字典里没有的取值改由 unseen(新列号, 取值) 决定编码（返回 -1 仍表示缺失）
+	Dataset recode(const vector<string>& names, const vector<ValueDictionary>& dictionaries,
+		const function<int(int, const string&)>& unseen = nullptr) const;
+
+	// 属性名 -> 列索引，找不到返回 -1
+	int findAttribute(const string& name) const;
+
+	int numRows() const { return rows; }
+	int numAttributes() const { return (int)attr_name.size(); }
+	const vector<string>& attributeNames() const { return attr_name; }
+	const ValueDictionary& dictionary(int col) const { return dicts[col]; }
+	const vector<int>& column(int col) const { return columns[col]; }
+
+	int code(int row, int col) const { return columns[col][row]; }
+	const string& valueAt(int row, int col) const { return dicts[col].value(columns[col][row]); }
+
+	// 估算占用的内存（字节）：编码列按已分配容量计算，加上各列字典
+	size_t memoryUsage() const;
+
+	// 解码出第 r 行的原始字符串
+	vector<string> row(int r) const;
+
+private:
+	vector<string> attr_name;          // 属性名列表
+	vector<ValueDictionary> dicts;     // 每列的取值字典
+	vector<vector<int>> columns;       // 每列的编码
+	int rows;                          // 行数
+};
\ No newline at end of file
@@ -0,0 +1,368 @@
+/* 2452214 霍宇哲 大数据 */
+#include "DatasetCache.h"
+#include "MappedFile.h"
+#include "BinaryIO.h"
+#include <iostream>
+#include <cstdint>
+#include <algorithm>
+#include <climits>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#endif
+
+static const char CACHE_MAGIC[4] = { 'I', 'D', '3', 'D' };
+static const size_t HEADER_SIZE = 16;
+static const size_t COLUMN_ENTRY_SIZE = 24;
+
+// 字典大小决定编码宽度
+static unsigned int codeWidth(int dictSize) {
+	if (dictSize <= 0x100)
+		return 1;
+	if (dictSize <= 0x10000)
+		return 2;
+	return 4;
+}
+
+// 解析文件头、列目录和字典区：base 是文件开头的 available 个字节（至少包含到字典区末尾），
+// fileSize 是整个文件的长度，用来检查各列数据区是否完整
+static bool parseCache(const char* base, size_t available, unsigned long long fileSize, unsigned int& numRows,
+	vector<CacheColumnInfo>& entries, vector<string>& names, vector<ValueDictionary>& dicts) {
+	if (available < HEADER_SIZE || memcmp(base, CACHE_MAGIC, 4) != 0)
+		return false;
+
+	BinaryCursor cursor(base, available, 4);
+	unsigned int version, numCols;
+	if (!cursor.readU32(version) || version != DATASET_CACHE_VERSION)
+		return false;
+	if (!cursor.readU32(numCols) || !cursor.readU32(numRows))
+		return false;
+	// 行数之后按 int 使用；列目录必须能放进已读入的字节，否则损坏的列数会先申请一大块内存
+	if (numRows > (unsigned int)INT_MAX || numCols > (available - HEADER_SIZE) / COLUMN_ENTRY_SIZE)
+		return false;
+
+	entries.assign(numCols, CacheColumnInfo());
+	for (CacheColumnInfo& e : entries) {
+		if (!cursor.readU64(e.dictOffset) || !cursor.readU64(e.dataOffset) ||
+			!cursor.readU32(e.dictSize) || !cursor.readU32(e.width))
+			return false;
+		// 先比较偏移再比较剩余长度，损坏的偏移不会让加法回绕
+		if ((e.width != 1 && e.width != 2 && e.width != 4) ||
+			e.dataOffset > fileSize || (unsigned long long)numRows * e.width > fileSize - e.dataOffset)
+			return false;
+	}
+
+	// 列名和字典
+	names.assign(numCols, string());
+	dicts.assign(numCols, ValueDictionary());
+	for (unsigned int j = 0; j < numCols; ++j) {
+		BinaryCursor dictCursor(base, available, entries[j].dictOffset);
+		StringRef ref;
+		if (!dictCursor.readRef(ref))
+			return false;
+		names[j].assign(ref.data, ref.size);
+		for (unsigned int code = 0; code < entries[j].dictSize; ++code) {
+			// 字典按编码顺序写入，重复的取值会被合并，字典变小后数据区的编码就会越界
+			if (!dictCursor.readRef(ref) || dicts[j].intern(ref.data, ref.size) != (int)code)
+				return false;
+		}
+	}
+	return true;
+}
+
+// 把 count 个 width 字节的编码展开成 int
+static void unpackCodes(const void* src, unsigned int width, int count, int* dst) {
+	if (width == 1) {
+		const uint8_t* p = (const uint8_t*)src;
+		for (int r = 0; r < count; ++r)
+			dst[r] = p[r];
+	}
+	else if (width == 2) {
+		const uint16_t* p = (const uint16_t*)src;
+		for (int r = 0; r < count; ++r)
+			dst[r] = p[r];
+	}
+	else {
+		memcpy(dst, src, (size_t)count * 4);
+	}
+}
+
+// 编码都在 [0, dictSize) 内；损坏的文件可能带有越界的编码，之后按编码下标访问计数表会越界，所以读入时就拒绝
+static bool codesInRange(const int* codes, int count, unsigned int dictSize) {
+	for (int r = 0; r < count; ++r)
+		if ((unsigned int)codes[r] >= dictSize)
+			return false;
+	return true;
+}
+
+DatasetCacheWriter::DatasetCacheWriter() : file(nullptr), rows(0), ok(false) {}
+
+DatasetCacheWriter::~DatasetCacheWriter() {
+	if (file)
+		close();
+}
+
+bool DatasetCacheWriter::open(const string& filename, const vector<string>& names, const vector<ValueDictionary>& dicts, int numRows) {
+	if (file)
+		close();
+	const int numCols = (int)names.size();
+	rows = numRows;
+	path = filename;
+
+	// 1. 计算布局
+	entries.assign(numCols, CacheColumnInfo());
+	unsigned long long offset = HEADER_SIZE + (unsigned long long)COLUMN_ENTRY_SIZE * numCols;
+	for (int j = 0; j < numCols; ++j) {
+		entries[j].dictOffset = offset;
+		entries[j].dictSize = dicts[j].size();
+		entries[j].width = codeWidth(dicts[j].size());
+		offset += 4 + names[j].size();
+		for (const string& v : dicts[j].allValues())
+			offset += 4 + v.size();
+	}
+	for (int j = 0; j < numCols; ++j) {
+		offset = alignTo8(offset);
+		entries[j].dataOffset = offset;
+		offset += (unsigned long long)numRows * entries[j].width;
+	}
+
+	file = fopen(filename.c_str(), "wb");
+	if (!file) {
+		cerr << "错误: 无法写入缓存文件 " << filename << endl;
+		ok = false;
+		return false;
+	}
+
+	// 2. 文件头和列目录
+	fwrite(CACHE_MAGIC, 1, 4, file);
+	writeU32(file, DATASET_CACHE_VERSION);
+	writeU32(file, (unsigned int)numCols);
+	writeU32(file, (unsigned int)numRows);
+	for (const CacheColumnInfo& e : entries) {
+		writeU64(file, e.dictOffset);
+		writeU64(file, e.dataOffset);
+		writeU32(file, e.dictSize);
+		writeU32(file, e.width);
+	}
+
+	// 3. 字典区，之后补零到第一列的数据区（数据区之间的对齐空隙在定位写入时由文件系统补零）
+	unsigned long long written = HEADER_SIZE + (unsigned long long)COLUMN_ENTRY_SIZE * numCols;
+	for (int j = 0; j < numCols; ++j) {
+		writeString(file, names[j]);
+		written += 4 + names[j].size();
+		for (const string& v : dicts[j].allValues()) {
+			writeString(file, v);
+			written += 4 + v.size();
+		}
+	}
+	if (numCols > 0)
+		writePadding(file, written, entries[0].dataOffset);
+
+	ok = !ferror(file);
+	return ok;
+}
+
+bool DatasetCacheWriter::writeRows(int col, int firstRow, const int* codes, int count) {
+	if (!file || !ok)
+		return false;
+	if (firstRow < 0 || count < 0 || firstRow + count > rows) {
+		ok = false;
+		return false;
+	}
+
+	// 按宽度打包
+	const CacheColumnInfo& e = entries[col];
+	packed.resize((size_t)count * e.width);
+	for (int r = 0; r < count; ++r) {
+		if (codes[r] < 0 || codes[r] >= (int)e.dictSize) {
+			cerr << "错误: 第 " << col << " 列含有未编码的取值，不能写入缓存" << endl;
+			ok = false;
+			return false;
+		}
+		if (e.width == 1)
+			packed[r] = (uint8_t)codes[r];
+		else if (e.width == 2)
+			((uint16_t*)packed.data())[r] = (uint16_t)codes[r];
+		else
+			((uint32_t*)packed.data())[r] = (uint32_t)codes[r];
+	}
+
+	ok = seekFile(file, e.dataOffset + (unsigned long long)firstRow * e.width) &&
+		fwrite(packed.data(), 1, packed.size(), file) == packed.size();
+	return ok;
+}
+
+bool DatasetCacheWriter::close() {
+	if (!file)
+		return false;
+	ok = ok && !ferror(file);
+	fclose(file);
+	file = nullptr;
+	if (!ok)
+		remove(path.c_str());
+	return ok;
+}
+
+bool saveDatasetCache(const Dataset& data, const string& filename) {
+	vector<ValueDictionary> dicts;
+	for (int j = 0; j < data.numAttributes(); ++j)
+		dicts.push_back(data.dictionary(j));
+
+	DatasetCacheWriter writer;
+	if (!writer.open(filename, data.attributeNames(), dicts, data.numRows())) {
+		writer.close();
+		return false;
+	}
+	for (int j = 0; j < data.numAttributes(); ++j)
+		if (!writer.writeRows(j, 0, data.column(j).data(), data.numRows()))
+			break;
+	return writer.close();
+}
+
+bool loadDatasetCache(const string& filename, Dataset& data) {
+	MappedFile file;
+	if (!file.open(filename))
+		return false;
+
+	const char* base = file.data();
+	unsigned int numRows;
+	vector<CacheColumnInfo> entries;
+	vector<string> names;
+	vector<ValueDictionary> dicts;
+	if (!parseCache(base, file.size(), file.size(), numRows, entries, names, dicts))
+		return false;
+
+	// 编码列：直接从映射的内存展开
+	Dataset result(names);
+	for (size_t j = 0; j < entries.size(); ++j) {
+		vector<int> codes(numRows);
+		unpackCodes(base + entries[j].dataOffset, entries[j].width, (int)numRows, codes.data());
+		if (!codesInRange(codes.data(), (int)numRows, entries[j].dictSize)) {
+			cerr << "错误: 缓存 " << filename << " 的第 " << j << " 列有超出字典范围的编码" << endl;
+			return false;
+		}
+		result.setColumn((int)j, dicts[j], move(codes));
+	}
+
+	data = move(result);
+	return true;
+}
+
+DatasetCacheReader::DatasetCacheReader() : file(nullptr), rows(0) {}
+
+DatasetCacheReader::~DatasetCacheReader() {
+	close();
+}
+
+bool DatasetCacheReader::open(const string& filename) {
+	close();
+	file = fopen(filename.c_str(), "rb");
+	if (!file)
+		return false;
+
+	// 先读文件头和列目录，得到字典区的范围，再把它整个读进来解析
+	unsigned long long length;
+	unsigned int numCols = 0;
+	buffer.resize(HEADER_SIZE);
+	if (!fileLength(file, length) || !seekFile(file, 0) ||
+		fread(buffer.data(), 1, HEADER_SIZE, file) != HEADER_SIZE) {
+		close();
+		return false;
+	}
+	memcpy(&numCols, buffer.data() + 8, 4);
+
+	unsigned long long headerEnd = HEADER_SIZE + (unsigned long long)COLUMN_ENTRY_SIZE * numCols;
+	unsigned long long prefix = headerEnd;
+	if (headerEnd <= length) {
+		buffer.resize((size_t)headerEnd);
+		if (fread(buffer.data() + HEADER_SIZE, 1, (size_t)(headerEnd - HEADER_SIZE), file) == headerEnd - HEADER_SIZE) {
+			// 字典区在第一个数据区之前
+			for (unsigned int j = 0; j < numCols; ++j) {
+				unsigned long long dataOffset;
+				memcpy(&dataOffset, buffer.data() + HEADER_SIZE + (size_t)COLUMN_ENTRY_SIZE * j + 8, 8);
+				prefix = j == 0 ? dataOffset : min(prefix, dataOffset);
+			}
+		}
+	}
+	if (prefix < headerEnd || prefix > length) {
+		close();
+		return false;
+	}
+
+	buffer.resize((size_t)prefix);
+	unsigned int numRows;
+	bool ok = seekFile(file, 0) && fread(buffer.data(), 1, buffer.size(), file) == buffer.size() &&
+		parseCache((const char*)buffer.data(), buffer.size(), length, numRows, entries, attr_name, dicts);
+	if (!ok) {
+		close();
+		return false;
+	}
+	rows = (int)numRows;
+	return true;
+}
+
+void DatasetCacheReader::close() {
+	if (file)
+		fclose(file);
+	file = nullptr;
+	rows = 0;
+	entries.clear();
+	attr_name.clear();
+	dicts.clear();
+}
+
+bool DatasetCacheReader::readRows(int firstRow, int count, vector<vector<int>>& columns) {
+	if (!file || firstRow < 0 || count < 0 || firstRow + count > rows)
+		return false;
+
+	columns.resize(entries.size());
+	for (size_t j = 0; j < entries.size(); ++j) {
+		const CacheColumnInfo& e = entries[j];
+		buffer.resize((size_t)count * e.width);
+		if (!seekFile(file, e.dataOffset + (unsigned long long)firstRow * e.width) ||
+			fread(buffer.data(), 1, buffer.size(), file) != buffer.size())
+			return false;
+		columns[j].resize(count);
+		unpackCodes(buffer.data(), e.width, count, columns[j].data());
+		if (!codesInRange(columns[j].data(), count, e.dictSize)) {
+			cerr << "错误: 缓存的第 " << j << " 列有超出字典范围的编码" << endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+// 文件修改时间，只用于互相比较：Windows 上是 100 纳秒为单位的 FILETIME 计数，其它平台是纳秒，起点也因平台而异
+// 文件不存在返回 false；只精确到秒时，同一秒内重写的 CSV 会被当成比缓存旧
+static bool modifiedTime(const string& filename, long long& mtime) {
+#ifdef _WIN32
+	WIN32_FILE_ATTRIBUTE_DATA info;
+	if (!GetFileAttributesExA(filename.c_str(), GetFileExInfoStandard, &info))
+		return false;
+	mtime = (long long)(((unsigned long long)info.ftLastWriteTime.dwHighDateTime << 32) | info.ftLastWriteTime.dwLowDateTime);
+#else
+	struct stat st;
+	if (stat(filename.c_str(), &st) != 0)
+		return false;
+#if defined(__APPLE__)
+	mtime = (long long)st.st_mtimespec.tv_sec * 1000000000LL + st.st_mtimespec.tv_nsec;
+#else
+	mtime = (long long)st.st_mtim.tv_sec * 1000000000LL + st.st_mtim.tv_nsec;
+#endif
+#endif
+	return true;
+}
+
+bool isDatasetCacheFresh(const string& cacheFile, const string& sourceFile) {
+	long long cacheTime, sourceTime;
+	if (!modifiedTime(cacheFile, cacheTime))
+		return false;
+	if (!modifiedTime(sourceFile, sourceTime))
+		return true; // 源文件不在了，只能用缓存
+	// 时间戳相同时无法判断谁先写，按失效处理（最多多做一次预处理）
+	return cacheTime > sourceTime;
+}
\ No newline at end of file
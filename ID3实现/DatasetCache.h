@@ -0,0 +1,93 @@
+/* 2452214 霍宇哲 大数据 */
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdio>
+#include "Dataset.h"
+
+using namespace std;
+
+// 编码数据集的二进制缓存格式（小端）：
+//   文件头      "ID3D" | 版本 u32 | 列数 u32 | 行数 u32
+//   列目录      每列 { 字典偏移 u64 | 数据偏移 u64 | 字典大小 u32 | 编码宽度 u32 }
+//   字典区      每列依次：列名 (u32 长度 + 字节)，然后每个取值 (u32 长度 + 字节)，按编码顺序
+//   数据区      每列的编码连续存放，起始处按 8 字节对齐；编码宽度按字典大小取 1 / 2 / 4 字节
+// 文本 CSV 解析和预处理只需做一次，之后的运行直接映射缓存文件，只需把紧凑的编码列展开成 int
+
+const unsigned int DATASET_CACHE_VERSION = 1;
+
+// 缓存中一列的元信息
+struct CacheColumnInfo {
+	unsigned long long dictOffset;
+	unsigned long long dataOffset;
+	unsigned int dictSize;
+	unsigned int width;       // 每个编码占用的字节数
+};
+
+// 流式写出缓存文件：先给出列名、各列字典和行数，之后按任意顺序写入各列的行块
+// 各列数据区的位置在 open 时就已确定，所以不需要把整个数据集放在内存里（例如边生成边写）
+class DatasetCacheWriter {
+public:
+	DatasetCacheWriter();
+	~DatasetCacheWriter();
+
+	// 写出文件头、列目录和字典区，失败返回 false
+	bool open(const string& filename, const vector<string>& names, const vector<ValueDictionary>& dicts, int numRows);
+
+	// 写入第 col 列的 [firstRow, firstRow + count) 行，编码必须在字典范围内，失败返回 false
+	bool writeRows(int col, int firstRow, const int* codes, int count);
+
+	// 关闭文件；之前有任何写入失败时删除文件并返回 false
+	bool close();
+
+private:
+	FILE* file;
+	string path;
+	vector<CacheColumnInfo> entries;
+	int rows;
+	bool ok;
+	vector<unsigned char> packed;
+
+	DatasetCacheWriter(const DatasetCacheWriter&) = delete;
+	DatasetCacheWriter& operator=(const DatasetCacheWriter&) = delete;
+};
+
+// 按行块顺序读取缓存文件：只把列名和字典读进内存，编码列每次读一段，不映射也不展开整个文件
+// 用于数据集大于内存时的外存训练；每次读取所有列中同一段行，各列内部都是顺序读
+class DatasetCacheReader {
+public:
+	DatasetCacheReader();
+	~DatasetCacheReader();
+
+	// 读取文件头、列目录和字典，失败（文件不存在、格式或版本不符）返回 false
+	bool open(const string& filename);
+	void close();
+
+	int numRows() const { return rows; }
+	int numAttributes() const { return (int)attr_name.size(); }
+	const vector<string>& attributeNames() const { return attr_name; }
+	const ValueDictionary& dictionary(int col) const { return dicts[col]; }
+
+	// 读取 [firstRow, firstRow + count) 行，columns[j] 得到第 j 列的编码，失败返回 false
+	bool readRows(int firstRow, int count, vector<vector<int>>& columns);
+
+private:
+	FILE* file;
+	vector<CacheColumnInfo> entries;
+	vector<string> attr_name;
+	vector<ValueDictionary> dicts;
+	int rows;
+	vector<unsigned char> buffer;
+
+	DatasetCacheReader(const DatasetCacheReader&) = delete;
+	DatasetCacheReader& operator=(const DatasetCacheReader&) = delete;
+};
+
+// 把编码数据集写成缓存文件，失败返回 false
+bool saveDatasetCache(const Dataset& data, const string& filename);
+
+// 映射缓存文件并还原数据集，失败（文件不存在、格式或版本不符）返回 false
+bool loadDatasetCache(const string& filename, Dataset& data);
+
+// 判断缓存文件是否存在且比源文件新（按文件系统记录的高精度修改时间比较，源文件更新后缓存即失效）
+bool isDatasetCacheFresh(const string& cacheFile, const string& sourceFile);
\ No newline at end of file
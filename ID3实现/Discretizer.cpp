@@ -0,0 +1,269 @@
+/* 2452214 霍宇哲 大数据 */
+#include "Discretizer.h"
+#include <iostream>
+#include <algorithm>
+#include <cstdio>
+
+// ---------------- QuantileSketch ----------------
+
+QuantileSketch::QuantileSketch(int capacity) : capacity(max(2, capacity)), total(0), sorted(true) {}
+
+void QuantileSketch::add(double value, long long weight) {
+	if (weight <= 0)
+		return;
+	points.push_back(make_pair(value, weight));
+	total += weight;
+	sorted = false;
+	if ((int)points.size() >= 2 * capacity)
+		compact();
+}
+
+void QuantileSketch::merge(const QuantileSketch& other) {
+	points.insert(points.end(), other.points.begin(), other.points.end());
+	total += other.total;
+	sorted = false;
+	if ((int)points.size() >= 2 * capacity)
+		compact();
+}
+
+void QuantileSketch::normalize() const {
+	if (sorted)
+		return;
+	sort(points.begin(), points.end());
+	size_t kept = 0;
+	for (size_t i = 0; i < points.size(); ++i) {
+		if (kept > 0 && points[kept - 1].first == points[i].first)
+			points[kept - 1].second += points[i].second;
+		else
+			points[kept++] = points[i];
+	}
+	points.resize(kept);
+	sorted = true;
+}
+
+// 按权重等分成 capacity / 2 段，每段保留段内最大的取值，权重为整段之和
+void QuantileSketch::compact() {
+	normalize();
+	if ((int)points.size() <= capacity)
+		return;
+
+	const int segments = capacity / 2;
+	vector<pair<double, long long>> kept;
+	kept.reserve(segments + 1);
+	long long accumulated = 0;
+	long long pending = 0;
+	int segment = 1;
+	for (const auto& p : points) {
+		accumulated += p.second;
+		pending += p.second;
+		if ((double)accumulated * segments >= (double)total * segment) {
+			kept.push_back(make_pair(p.first, pending));
+			pending = 0;
+			while (segment < segments && (double)accumulated * segments >= (double)total * segment)
+				segment++;
+		}
+	}
+	if (pending > 0)
+		kept.push_back(make_pair(points.back().first, pending));
+	points.swap(kept);
+}
+
+double QuantileSketch::quantile(double q) const {
+	if (total == 0)
+		return 0;
+	normalize();
+	const double target = min(1.0, max(0.0, q)) * total;
+	long long accumulated = 0;
+	for (const auto& p : points) {
+		accumulated += p.second;
+		if (accumulated >= target)
+			return p.first;
+	}
+	return points.back().first;
+}
+
+// ---------------- Discretizer ----------------
+
+Discretizer::Discretizer(const BinningOptions& options) : options(options) {
+	this->options.bins = max(1, options.bins);
+}
+
+bool Discretizer::fit(const Dataset& data, const vector<string>& names) {
+	bool ok = true;
+	for (const string& name : names) {
+		int col = data.findAttribute(name);
+		if (col < 0) {
+			cerr << "错误: 离散化的列 " << name << " 不存在" << endl;
+			ok = false;
+			continue;
+		}
+
+		// 1. 字典里的每个取值只解析一次
+		const ValueDictionary& dict = data.dictionary(col);
+		vector<double> numbers(dict.size());
+		vector<char> numeric(dict.size());
+		for (int code = 0; code < dict.size(); ++code)
+			numeric[code] = parseNumber(dict.value(code), numbers[code]);
+
+		// 2. 取值太多的列按分位数分箱时不建直方图，逐行把数值喂给固定大小的草图
+		vector<double> cuts;
+		bool found = false;
+		if (options.method == BINNING_QUANTILE && dict.size() > DISCRETIZE_EXACT_VALUES) {
+			QuantileSketch sketch;
+			for (int code : data.column(col))
+				if (code >= 0 && numeric[code])
+					sketch.add(numbers[code]);
+			found = sketch.totalWeight() > 0;
+			if (found)
+				cuts = sketchCuts(sketch);
+		}
+		// 3. 否则一遍扫描得到每个编码的行数，切点只在这个直方图上计算
+		else {
+			vector<long long> counts(dict.size(), 0);
+			for (int code : data.column(col))
+				if (code >= 0)
+					counts[code]++;
+			vector<pair<double, long long>> histogram;
+			for (int code = 0; code < dict.size(); ++code)
+				if (numeric[code] && counts[code] > 0)
+					histogram.push_back(make_pair(numbers[code], counts[code]));
+			found = !histogram.empty();
+			if (found)
+				cuts = computeCuts(histogram);
+		}
+		if (!found) {
+			cerr << "错误: 列 " << name << " 没有数字取值，无法离散化" << endl;
+			ok = false;
+			continue;
+		}
+
+		ColumnBins& bins = columns[name];
+		bins.cuts = move(cuts);
+		bins.labels = intervalLabels(bins.cuts);
+	}
+	return ok;
+}
+
+vector<double> Discretizer::computeCuts(vector<pair<double, long long>>& histogram) const {
+	const int numBins = options.bins;
+	vector<double> cuts;
+	double maxValue;
+
+	if (options.method == BINNING_EQUAL_WIDTH) {
+		double minValue = histogram[0].first;
+		maxValue = histogram[0].first;
+		for (const auto& h : histogram) {
+			minValue = min(minValue, h.first);
+			maxValue = max(maxValue, h.first);
+		}
+		for (int i = 1; i < numBins; ++i)
+			cuts.push_back(minValue + (maxValue - minValue) * i / numBins);
+	}
+	else {
+		// 精确分位数：按取值排序后累加行数，第 i 个切点是累计行数首次达到 i / bins 的取值
+		sort(histogram.begin(), histogram.end());
+		long long total = 0;
+		for (const auto& h : histogram)
+			total += h.second;
+		long long accumulated = 0;
+		size_t k = 0;
+		for (int i = 1; i < numBins; ++i) {
+			const double target = (double)total * i / numBins;
+			while (k < histogram.size() && accumulated + histogram[k].second < target)
+				accumulated += histogram[k++].second;
+			if (k < histogram.size())
+				cuts.push_back(histogram[k].first);
+		}
+		maxValue = histogram.back().first;
+	}
+
+	trimCuts(cuts, maxValue);
+	return cuts;
+}
+
+vector<double> Discretizer::sketchCuts(const QuantileSketch& sketch) const {
+	vector<double> cuts;
+	for (int i = 1; i < options.bins; ++i)
+		cuts.push_back(sketch.quantile((double)i / options.bins));
+	trimCuts(cuts, sketch.quantile(1.0));
+	return cuts;
+}
+
+void Discretizer::trimCuts(vector<double>& cuts, double maxValue) {
+	sort(cuts.begin(), cuts.end());
+	cuts.erase(unique(cuts.begin(), cuts.end()), cuts.end());
+	while (!cuts.empty() && cuts.back() >= maxValue)
+		cuts.pop_back();
+}
+
+void Discretizer::setCuts(const string& column, const vector<double>& cuts, const vector<string>& labels) {
+	ColumnBins& bins = columns[column];
+	bins.cuts = cuts;
+	sort(bins.cuts.begin(), bins.cuts.end());
+	bins.cuts.erase(unique(bins.cuts.begin(), bins.cuts.end()), bins.cuts.end());
+	if (labels.size() == bins.cuts.size() + 1) {
+		bins.labels = labels;
+	}
+	else {
+		if (!labels.empty())
+			cerr << "警告: 列 " << column << " 的箱名个数应比切点多一个，改用区间命名" << endl;
+		bins.labels = intervalLabels(bins.cuts);
+	}
+}
+
+string Discretizer::binLabel(const string& column, const string& value) const {
+	const ColumnBins& bins = columns.at(column);
+	double number;
+	if (!parseNumber(value, number))
+		return options.missingLabel;
+	return bins.labels[lower_bound(bins.cuts.begin(), bins.cuts.end(), number) - bins.cuts.begin()];
+}
+
+void Discretizer::transform(Dataset& data) const {
+	for (const auto& entry : columns) {
+		int col = data.findAttribute(entry.first);
+		if (col < 0)
+			continue;
+		const ColumnBins& bins = entry.second;
+		const ValueDictionary& dict = data.dictionary(col);
+
+		// 每个不同的取值只解析一次，得到它的箱号（bins 号是不是数字的取值）
+		const int missing = (int)bins.labels.size();
+		vector<int> translate(dict.size());
+		vector<char> used(missing + 1, 0);
+		for (int code = 0; code < dict.size(); ++code) {
+			double number;
+			translate[code] = parseNumber(dict.value(code), number) ?
+				(int)(lower_bound(bins.cuts.begin(), bins.cuts.end(), number) - bins.cuts.begin()) : missing;
+			used[translate[code]] = 1;
+		}
+
+		// 字典只放出现过的箱名，按字典序编码，箱号 -> 编码
+		ValueDictionary labels;
+		vector<int> binCode(missing + 1, -1);
+		for (int b = 0; b <= missing; ++b)
+			if (used[b])
+				binCode[b] = labels.intern(b < missing ? bins.labels[b] : options.missingLabel);
+		vector<int> remap = labels.sortValues();
+		for (int& t : translate)
+			t = remap[binCode[t]];
+
+		// 逐行只查表
+		data.remapColumn(col, labels, translate);
+	}
+}
+
+static string formatCut(double value) {
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%g", value);
+	return buf;
+}
+
+vector<string> Discretizer::intervalLabels(const vector<double>& cuts) {
+	vector<string> labels;
+	for (size_t i = 0; i <= cuts.size(); ++i) {
+		string low = i == 0 ? "-inf" : formatCut(cuts[i - 1]);
+		labels.push_back("(" + low + ", " + (i == cuts.size() ? "+inf)" : formatCut(cuts[i]) + "]"));
+	}
+	return labels;
+}
\ No newline at end of file
@@ -0,0 +1,96 @@
+/* 2452214 霍宇哲 大数据 */
+#pragma once
+#include <vector>
+#include <string>
+#include <map>
+#include <utility>
+#include "Dataset.h"
+
+using namespace std;
+
+const int DISCRETIZE_EXACT_VALUES = 1 << 16;  // 字典里的取值数不超过它的列建直方图精确计算分位数，更多时（例如连续的浮点数）逐行喂给 QuantileSketch
+const int QUANTILE_SKETCH_CAPACITY = 1 << 12; // QuantileSketch 默认保留的点数
+
+// 分箱方式
+enum BinningMethod {
+	BINNING_EQUAL_WIDTH,  // 最小值到最大值等分
+	BINNING_QUANTILE      // 按分位数切分，各箱的行数大致相同
+};
+
+struct BinningOptions {
+	BinningMethod method;
+	int bins;             // 箱数（分位数切点重合时实际会少一些）
+	string missingLabel;  // 不是数字的取值（空串、NA 等）归入的箱
+
+	BinningOptions() : method(BINNING_QUANTILE), bins(4), missingLabel("未知") {}
+};
+
+// 流式的带权分位数草图：内存固定为 capacity 个点，可以合并
+// 点数超过上限时把有序的点按权重等分成 capacity / 2 段，每段只保留一个点（段内的最大值）和整段的权重，
+// 所以任意分位数的秩误差不超过 总权重 / (capacity / 2) 乘以压缩的轮数，最大值始终是精确的
+class QuantileSketch {
+public:
+	explicit QuantileSketch(int capacity = QUANTILE_SKETCH_CAPACITY);
+
+	void add(double value, long long weight = 1);
+	void merge(const QuantileSketch& other);
+
+	long long totalWeight() const { return total; }
+
+	// 累计权重首次达到 q * 总权重 的取值（q 在 [0, 1]），草图为空时返回 0
+	double quantile(double q) const;
+
+private:
+	int capacity;
+	long long total;
+	mutable vector<pair<double, long long>> points;  // (取值, 权重)
+	mutable bool sorted;
+
+	void normalize() const;  // 排序并合并相同的取值
+	void compact();
+};
+
+// 数值列的离散化：先算出每列的切点，再把列换成箱的编码
+// 箱 i 是 (cuts[i-1], cuts[i]]，与 ID3 数值属性的 <= 阈值一致
+// 每列只把字典里的每个取值解析一次，切点在 取值 x 行数 的直方图上计算（取值太多的列改用固定大小的草图，不建直方图），
+// 逐行的工作只有一次查表（见 Dataset::remapColumn），所以代价与行数成正比、与取值字符串无关；在训练集上 fit，再用同样的切点 transform 测试集
+class Discretizer {
+public:
+	explicit Discretizer(const BinningOptions& options = BinningOptions());
+
+	// 在 data 上为这些列计算切点；列不存在或没有数字时报错并跳过该列，返回 false
+	bool fit(const Dataset& data, const vector<string>& columns);
+
+	// 直接指定一列的切点（升序）和各箱的名字（比切点多一个，为空时按区间自动命名）
+	void setCuts(const string& column, const vector<double>& cuts, const vector<string>& labels = vector<string>());
+
+	// 把 data 中有切点的列就地换成箱（字典是箱的名字，按字典序编码）；data 中没有的列跳过
+	void transform(Dataset& data) const;
+
+	bool hasColumn(const string& column) const { return columns.count(column) > 0; }
+	const vector<double>& cuts(const string& column) const { return columns.at(column).cuts; }
+
+	// 取值落在哪个箱的名字，不是数字时为 missingLabel
+	string binLabel(const string& column, const string& value) const;
+
+private:
+	struct ColumnBins {
+		vector<double> cuts;
+		vector<string> labels;  // labels[i] 是箱 i 的名字
+	};
+
+	BinningOptions options;
+	map<string, ColumnBins> columns;
+
+	// 按 options 从 (取值, 行数) 的直方图计算切点
+	vector<double> computeCuts(vector<pair<double, long long>>& histogram) const;
+
+	// 从草图估计分位数切点
+	vector<double> sketchCuts(const QuantileSketch& sketch) const;
+
+	// 去掉重复的和不小于最大值的切点（它们只会产生空箱）
+	static void trimCuts(vector<double>& cuts, double maxValue);
+
+	// 自动生成的箱名： (-inf, a]、(a, b]、(b, +inf)
+	static vector<string> intervalLabels(const vector<double>& cuts);
+};
\ No newline at end of file
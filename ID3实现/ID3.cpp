@@ -1,34 +1,119 @@
-/* 2452214   */
+/* 2452214 霍宇哲 大数据 */
 #include "ID3.h"
+#include "BinaryIO.h"
+#include "DatasetCache.h"
+#include "Random.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
-// 캯
-ID3::ID3() : root(nullptr), target_index(-1) {}
+static const char MODEL_MAGIC[4] = { 'M', 'I', 'D', '3' };
+static const size_t MODEL_HEADER_SIZE = 32;
+static_assert(sizeof(FlatNode) == 16, "FlatNode 在模型文件中按 16 字节存放");
 
-// 
+// 浮点数按能精确还原的位数输出
+static string numberText(double value) {
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%.17g", value);
+	return buf;
+}
+
+// 构造函数
+ID3::ID3() : root(nullptr), attr_dicts(make_shared<const vector<ValueDictionary>>()), target_index(-1), dataset(nullptr), root_counts(nullptr), thread_count(1), trace_events(false),
+	feature_subset(0), feature_seed(0), incremental(false), stats_size(0), tree_nodes(nullptr), tree_size(0) {}
+
+// 设置训练线程数，0 表示使用全部硬件线程
+void ID3::setThreadCount(int threads) {
+	if (threads <= 0)
+		threads = (int)thread::hardware_concurrency();
+	thread_count = max(1, threads);
+}
+
+// 写出最近一次训练的 trace
+bool ID3::writeTrainTrace(const string& filename) const {
+#ifdef ID3_PROFILE
+	return profiler.writeChromeTrace(filename);
+#else
+	cerr << "错误: 没有用 ID3_PROFILE 编译，无法写出训练 trace " << filename << endl;
+	return false;
+#endif
+}
+
+// 析构函数
 ID3::~ID3() {
-	destroyTree(root);
+	destroyTree();
+}
+
+// 释放内存：节点都在 Arena 里，不需要逐个遍历
+void ID3::destroyTree() {
+	tree_arena.clear();
+	root = nullptr;
+}
+
+TreeNode* ID3::makeLeaf(int label) {
+	ID3_PROFILE_SCOPE(profiler, PHASE_ALLOC);
+	ID3_PROFILE_BYTES(profiler, sizeof(TreeNode));
+	TreeNode* node = tree_arena.create<TreeNode>(arenaLane());
+	node->isLeaf = true;
+	node->label = label;
+	return node;
+}
+
+// 训练入口
+void ID3::train(const vector<vector<string>>& data, const vector<string>& attributeNames, const string& target) {
+	// 先把字符串表一次性编码为列式数据集，之后全部在整数编码上计算
+	Dataset encoded = Dataset::fromRows(data, attributeNames);
+	train(encoded, target);
 }
 
-// ݹͷڴ
-void ID3::destroyTree(TreeNode* node) {
-	if (node) {
-		for (auto& pair : node->children) {
-			destroyTree(pair.second);
+// 训练入口（编码数据集）
+void ID3::train(const Dataset& data, const string& target) {
+	ID3_PROFILE_BEGIN(profiler, trace_events);
+	{
+		ID3_PROFILE_SCOPE(profiler, PHASE_TRAIN);
+		if (incremental) {
+			// 增量模式保存一份训练数据，之后 update 在它上面累积
+			history = data;
+			trainTree(history, target);
+		}
+		else {
+			history = Dataset();
+			trainTree(data, target);
 		}
-		delete node;
 	}
+	ID3_PROFILE_END(profiler, train_stats);
 }
 
-// ѵ
-void ID3::train(const vector<vector<string>>& data, const vector<string>& attributeNames, const string& target) {
-	// 1. ʼԪ
+// 训练入口（根节点使用预先统计好的计数）
+void ID3::train(const Dataset& data, const string& target, const RootCounts& rootCounts) {
+	root_counts = &rootCounts;
+	train(data, target);
+	root_counts = nullptr;
+}
+
+bool ID3::resetModel(const vector<string>& attributeNames, const string& target) {
+	// 1. 初始化元数据
 	this->attr_name = attributeNames;
 	this->target_index = -1;
 	this->attr_index_map.clear();
-	this->attr_values.clear();
+	this->attr_dicts = make_shared<const vector<ValueDictionary>>();
+	this->numeric_attr.clear();
+	this->numeric_values.clear();
+	this->numeric_order.clear();
+	this->numeric_cells.clear();
+	this->code_limit.clear();
+	this->flat_nodes.clear();
+	this->tree_nodes = nullptr;
+	this->tree_size = 0;
+	this->model_file.reset();
+	destroyTree(); // 重新训练时释放上一棵树
 
-	// 2.   ->  ӳ䣬ҵ Target 
-	for (int i = 0; i < attributeNames.size(); ++i) {
+	// 2. 建立 属性名 -> 索引 的映射，并找到 Target 列
+	for (int i = 0; i < (int)attributeNames.size(); ++i) {
 		attr_index_map[attributeNames[i]] = i;
 		if (attributeNames[i] == target) {
 			target_index = i;
@@ -36,62 +121,257 @@ void ID3::train(const vector<vector<string>>& data, const vector<string>& attrib
 	}
 
 	if (target_index == -1) {
-		cerr << "Ŀûг" << endl;
+		cerr << "目标属性没有出现在属性中" << endl;
+		return false;
+	}
+	return true;
+}
+
+void ID3::setupNumeric(const vector<string>& names) {
+	const int numAttrs = (int)attr_name.size();
+	numeric_attr.assign(numAttrs, 0);
+	numeric_values.assign(numAttrs, vector<double>());
+	numeric_order.assign(numAttrs, vector<int>());
+	for (const string& name : names) {
+		auto it = attr_index_map.find(name);
+		if (it == attr_index_map.end())
+			continue;
+		const int j = it->second;
+		const ValueDictionary& dict = dictionary(j);
+		vector<double> values(dict.size());
+		bool numeric = true;
+		for (int code = 0; code < dict.size() && numeric; ++code)
+			numeric = parseNumber(dict.value(code), values[code]);
+		if (!numeric) {
+			cerr << "警告: 列 " << name << " 有不是数字的取值，按分类属性处理" << endl;
+			continue;
+		}
+
+		// 编码按数值排序（数值相同的按编码），训练时按这个顺序扫描计数表
+		vector<int> order(dict.size());
+		for (int code = 0; code < dict.size(); ++code)
+			order[code] = code;
+		stable_sort(order.begin(), order.end(), [&](int a, int b) { return values[a] < values[b]; });
+		numeric_attr[j] = 1;
+		numeric_values[j] = move(values);
+		numeric_order[j] = move(order);
+	}
+	setEncodingThresholds(vector<vector<double>>());
+}
+
+void ID3::collectThresholds(vector<vector<double>>& thresholds) const {
+	if (thresholds.size() < attr_name.size())
+		thresholds.resize(attr_name.size());
+	for (int i = 0; i < tree_size; ++i) {
+		const FlatNode& node = tree_nodes[i];
+		if (node.attr >= 0 && numeric_attr[node.attr])
+			thresholds[node.attr].push_back(node.threshold);
+	}
+}
+
+void ID3::setEncodingThresholds(const vector<vector<double>>& thresholds) {
+	const int numAttrs = (int)attr_name.size();
+	numeric_cells.assign(numAttrs, vector<double>());
+	code_limit.assign(numAttrs, 0);
+	for (int j = 0; j < numAttrs; ++j) {
+		const int dictSize = dictionary(j).size();
+		code_limit[j] = dictSize;
+		if (!numeric_attr[j])
+			continue;
+		vector<double>& cells = numeric_cells[j];
+		if (j < (int)thresholds.size())
+			cells = thresholds[j];
+		sort(cells.begin(), cells.end());
+		cells.erase(unique(cells.begin(), cells.end()), cells.end());
+
+		// 区间的代表值取它的右端点 t[k]，最后一个区间取比最大阈值大一点的数，与各阈值比较的结果和区间里的数相同
+		vector<double>& values = numeric_values[j];
+		values.resize(dictSize);
+		values.insert(values.end(), cells.begin(), cells.end());
+		values.push_back(cells.empty() ? 0.0 : nextafter(cells.back(), HUGE_VAL));
+		code_limit[j] = dictSize + (int)cells.size() + 1;
+	}
+}
+
+void ID3::resetEncoding() {
+	vector<vector<double>> thresholds;
+	collectThresholds(thresholds);
+	setEncodingThresholds(thresholds);
+}
+
+// 带行权重训练：每行按权重重复出现在行号列表里
+void ID3::train(const Dataset& data, const string& target, const vector<int>& weights) {
+	if ((int)weights.size() != data.numRows()) {
+		cerr << "错误: 权重个数与数据行数不一致" << endl;
 		return;
 	}
+	vector<int> rowIds;
+	for (int r = 0; r < data.numRows(); ++r)
+		rowIds.insert(rowIds.end(), max(0, weights[r]), r);
+	trainOnRows(data, target, rowIds);
+}
 
-	// 3. Ԥ¼ÿпֵܳΨһֵ
-	// ڴԼг֡ѵǰ֧ûֵֵҪ
-	for (int j = 0; j < attributeNames.size(); ++j) {
-		if (j == target_index)
-			continue; // Ŀ
-		set<string> unique_vals;
-		for (const auto& row : data) {
-			unique_vals.insert(row[j]);
+// 在行号列表上训练
+void ID3::trainOnRows(const Dataset& data, const string& target, const vector<int>& rowIds) {
+	if (incremental) {
+		cerr << "错误: 增量模式只能在完整的数据集上训练" << endl;
+		return;
+	}
+	for (int r : rowIds) {
+		if (r < 0 || r >= data.numRows()) {
+			cerr << "错误: 行号 " << r << " 超出数据集范围" << endl;
+			return;
 		}
-		// ת浽 vector
-		for (const string& v : unique_vals) {
-			attr_values[attributeNames[j]].push_back(v);
+	}
+
+	ID3_PROFILE_BEGIN(profiler, trace_events);
+	{
+		ID3_PROFILE_SCOPE(profiler, PHASE_TRAIN);
+		history = Dataset();
+		trainTree(data, target, &rowIds);
+	}
+	ID3_PROFILE_END(profiler, train_stats);
+}
+
+// 只比较列数和各列的取值数：shareDictionaries 的调用方保证内容相同，这里只挡住明显用错的情况
+bool ID3::sameDictionaries(const vector<ValueDictionary>& dicts, const Dataset& data) {
+	if ((int)dicts.size() != data.numAttributes())
+		return false;
+	for (int j = 0; j < data.numAttributes(); ++j)
+		if (dicts[j].size() != data.dictionary(j).size())
+			return false;
+	return true;
+}
+
+void ID3::setFeatureSubset(int count, unsigned int seed) {
+	feature_subset = max(0, count);
+	feature_seed = seed;
+}
+
+void ID3::trainTree(const Dataset& data, const string& target, const vector<int>* rowIds) {
+	vector<bool> usedAttributes;
+	{
+		ID3_PROFILE_SCOPE(profiler, PHASE_METADATA);
+
+		// 1、2. 初始化元数据，找到 Target 列
+		if (!resetModel(data.attributeNames(), target))
+			return;
+
+		// 3. 预处理：记录每个属性所有可能出现的唯一值
+		// 这对于处理测试集中出现、但训练集当前分支没出现的属性值很重要
+		// 编码数据集的字典里就是每列的全部唯一值，直接转存即可（目标列的字典即类别字典，预测时用来解码）
+		// shareDictionaries 给出了同一份字典时直接共享，不再复制
+		if (shared_dicts && sameDictionaries(*shared_dicts, data)) {
+			attr_dicts = shared_dicts;
+		}
+		else {
+			vector<ValueDictionary> dicts;
+			for (int j = 0; j < (int)attr_name.size(); ++j) {
+				dicts.push_back(data.dictionary(j));
+			}
+			attr_dicts = make_shared<const vector<ValueDictionary>>(move(dicts));
+		}
+		shared_dicts.reset();
+		setupNumeric(numeric_names);
+
+		// 4. 初始化属性使用状态 (全部为 false)
+		usedAttributes.assign(attr_name.size(), false);
+		usedAttributes[target_index] = true; // 目标列本身不参与分裂
+
+		// 5. 整棵树共享一个行号数组，每个节点只拥有其中的一段 [begin, end)
+		// 给定行号列表时直接使用它（重复的行号在计数时就相当于带权重）
+		if (rowIds) {
+			row_index = *rowIds;
+
+			// 记下各分类列在这些行里出现过的取值：没出现过的取值与只用这些行的子集（Dataset::select）训练时一样，
+			// 不属于模型见过的取值，它的分支是不给类别的叶子，而不是父节点的多数类
+			value_seen.assign(attr_name.size(), vector<char>());
+			for (int j = 0; j < (int)attr_name.size(); ++j) {
+				if (j == target_index || numeric_attr[j])
+					continue;
+				const vector<int>& column = data.column(j);
+				value_seen[j].assign(dictionary(j).size(), 0);
+				for (int r : row_index)
+					value_seen[j][column[r]] = 1;
+			}
+		}
+		else {
+			row_index.resize(data.numRows());
+			for (int r = 0; r < data.numRows(); ++r)
+				row_index[r] = r;
 		}
 	}
 
-	// 4. ʼʹ״̬ (ȫΪ false)
-	vector<bool> usedAttributes(attributeNames.size(), false);
-	usedAttributes[target_index] = true; // Ŀб
+	// 6. 开始递归构建（每个线程在 Arena 里用自己的通道分配节点）
+	if (thread_count > 1) {
+		pool.reset(new ThreadPool(thread_count));
+		tree_arena.setLanes(thread_count);
+	}
+
+	this->dataset = &data;
+	root = buildTree(0, (int)row_index.size(), 0, usedAttributes);
+	this->dataset = nullptr;
+	pool.reset();
+	vector<int>().swap(row_index); // 训练结束后释放行号数组
+	vector<vector<char>>().swap(value_seen);
 
-	// 5. ʼݹ鹹
-	root = buildTree(data, usedAttributes);
+	// 7. 把树编译成推理用的扁平数组
+	{
+		ID3_PROFILE_SCOPE(profiler, PHASE_COMPILE);
+		compileTree();
+	}
+
+	if (incremental)
+		initStats();
 }
 
-// ĵݹ鹹
-TreeNode* ID3::buildTree(vector<vector<string>> currentData, vector<bool> usedAttributes) {
-	TreeNode* node = new TreeNode();
+// 核心递归构建函数
+TreeNode* ID3::buildTree(int begin, int end, int depth, vector<bool>& usedAttributes) {
+	const vector<int>& labels = dataset->column(target_index);
+	ID3_PROFILE_NODE(profiler, depth);
 
-	// --- 1. ֹ ---
+	// --- 1. 终止条件检查 ---
 
-	// A. ݼΪ
-	if (currentData.empty()) {
-		node->isLeaf = true;
-		node->label = "ݼǿյ"; // ȡڵĶ
-		return node;
+	// A. 如果数据集为空
+	if (begin == end) {
+		return makeLeaf(-1); // 数据集是空的，或者取父节点的多数类
 	}
 
-	// B. ݼͬһ ()
-	string firstLabel = currentData[0][target_index];
+	// B. 如果数据集中所有样本都属于同一类 (纯净)
+	int firstLabel = labels[row_index[begin]];
 	bool isPure = true;
-	for (const auto& row : currentData) {
-		if (row[target_index] != firstLabel) {
-			isPure = false;
-			break;
+	int majorityLabel = -1;
+	if (depth == 0 && root_counts) {
+		// 根节点的类别计数已经统计好，不再扫描（多数类的平局规则与 getMajorityLabel 相同）
+		const vector<int>& classCounts = root_counts->classCounts;
+		int nonEmpty = 0;
+		int maxCount = -1;
+		for (int code = 0; code < (int)classCounts.size(); ++code) {
+			nonEmpty += classCounts[code] > 0;
+			if (classCounts[code] > maxCount) {
+				maxCount = classCounts[code];
+				majorityLabel = code;
+			}
 		}
+		isPure = nonEmpty == 1;
+	}
+	else {
+		ID3_PROFILE_SCOPE(profiler, PHASE_ENTROPY);
+		int scanned = begin;
+		for (; scanned < end; ++scanned) {
+			if (labels[row_index[scanned]] != firstLabel) {
+				isPure = false;
+				break;
+			}
+		}
+		ID3_PROFILE_ROWS(profiler, scanned - begin);
+		majorityLabel = isPure ? firstLabel : getMajorityLabel(begin, end);
 	}
 	if (isPure) {
-		node->isLeaf = true;
-		node->label = firstLabel;
-		return node;
+		return makeLeaf(firstLabel);
 	}
 
-	// C. Զˣûпõ
+	// C. 如果所有属性都用完了，但还没有完全分开
 	bool allUsed = true;
 	for (bool u : usedAttributes) {
 		if (!u) {
@@ -100,174 +380,1574 @@ TreeNode* ID3::buildTree(vector<vector<string>> currentData, vector<bool> usedAt
 		}
 	}
 	if (allUsed) {
-		node->isLeaf = true;
-		node->label = getMajorityLabel(currentData); // 
-		return node;
+		return makeLeaf(majorityLabel); // 多数表决
 	}
 
-	// --- 2. Ѱѷ ---
-	int bestAttrIndex = getBestAttribute(currentData, usedAttributes);
+	// --- 2. 寻找最佳分裂属性 ---
+	double threshold = 0;
+	int bestAttrIndex = getBestAttribute(begin, end, depth, usedAttributes, threshold);
 
-	// ޷ҵ (漫С)Ҳֹͣ
+	// 如果无法找到有增益的属性 (增益极小)，也停止
 	if (bestAttrIndex == -1) {
-		node->isLeaf = true;
-		node->label = getMajorityLabel(currentData);
-		return node;
+		return makeLeaf(majorityLabel);
+	}
+
+	// --- 3. 创建节点 ---
+	const int numBranches = branchCount(bestAttrIndex);
+	const bool numeric = numeric_attr[bestAttrIndex] != 0;
+	TreeNode* node;
+	TreeNode** childNodes;
+	{
+		ID3_PROFILE_SCOPE(profiler, PHASE_ALLOC);
+		ID3_PROFILE_BYTES(profiler, sizeof(TreeNode) + sizeof(TreeNode*) * numBranches);
+		node = tree_arena.create<TreeNode>(arenaLane());
+		childNodes = tree_arena.createArray<TreeNode*>(numBranches, arenaLane());
 	}
+	node->attr = bestAttrIndex;
+	node->children = childNodes;
+	node->threshold = threshold;
+
+	// 标记该属性已使用 (usedAttributes 是按引用共享的，子树建完后要恢复，只影响当前子树)
+	// 数值属性不标记，子树里还可以换个阈值再分
+	if (!numeric)
+		usedAttributes[bestAttrIndex] = true;
 
-	// --- 3. ڵ ---
-	node->Attribute = attr_name[bestAttrIndex];
+	// 把 [begin, end) 按分支原地划分，bounds[v] ~ bounds[v + 1] 是第 v 个分支的行
+	vector<int> bounds = splitData(begin, end, bestAttrIndex, threshold);
 
-	// Ǹʹ (ע⣺usedAttributes ǰֵݵģ޸ֻӰ쵱ǰ)
-	usedAttributes[bestAttrIndex] = true;
+	// --- 4. 递归生成子节点 ---
+	// 遍历该属性的所有可能取值 (即全局字典中的全部编码，而不是只取当前数据的 unique)
+	// 这样可以防止测试数据中有 valid 的值，但当前分支的训练数据中由于缺失该值导致的 Crash
+	// 数值属性的两个分支按阈值切在两个出现过的取值之间，都不会为空
 
-	// --- 4. ݹӽڵ ---
-	// Եпȡֵ (ȫԪ attr_values ȡֻȡǰݵ unique)
-	// Էֹ valid ֵǰ֧ѵȱʧֵµ Crash
-	const vector<string>& allPossibleValues = attr_values[attr_name[bestAttrIndex]];
+	// 各分支的行号段互不重叠，子树可以独立构建
+	// 行数达到 TASK_MIN_ROWS 的分支作为任务交给线程池（带一份自己的 usedAttributes），
+	// 较小的分支在当前线程串行递归；各分支只写 children 中属于自己的那一格
+	TaskGroup subtrees;
 
-	for (const string& val : allPossibleValues) {
-		// ָ
-		vector<vector<string>> subData = splitData(currentData, bestAttrIndex, val);
+	for (int code = 0; code < numBranches; ++code) {
+		int childBegin = bounds[code];
+		int childEnd = bounds[code + 1];
 
-		if (subData.empty()) {
-			// ֵڵǰݼûһҶӽڵ㣬ΪϵĶ
-			TreeNode* leafChild = new TreeNode();
-			leafChild->isLeaf = true;
-			leafChild->label = getMajorityLabel(currentData);
-			node->children[val] = leafChild;
+		if (childBegin == childEnd) {
+			// 如果这个值在当前数据集中没有样本，创建一个叶子节点，标记为父集合的多数类
+			// 在行号列表上训练、而这个值在全部训练行里都没有出现时，叶子不给类别（见 trainTree）
+			ID3_PROFILE_NODE(profiler, depth + 1);
+			const bool seen = value_seen.empty() || numeric || value_seen[bestAttrIndex][code];
+			childNodes[code] = makeLeaf(seen ? majorityLabel : -1);
+		}
+		else if (pool && childEnd - childBegin >= TASK_MIN_ROWS) {
+			// 并行构建子树
+			pool->run(subtrees, [this, childNodes, code, childBegin, childEnd, depth, usedAttributes]() mutable {
+				childNodes[code] = buildTree(childBegin, childEnd, depth + 1, usedAttributes);
+			});
 		}
 		else {
-			// ݹ鹹
-			node->children[val] = buildTree(subData, usedAttributes);
+			// 递归构建子树
+			childNodes[code] = buildTree(childBegin, childEnd, depth + 1, usedAttributes);
 		}
 	}
 
+	if (pool)
+		pool->wait(subtrees);
+
+	if (!numeric)
+		usedAttributes[bestAttrIndex] = false;
 	return node;
 }
 
-// Ϣ
-double ID3::calculateEntropy(const vector<vector<string>>& data) const {
-	if (data.empty())
+// 计算信息熵：counts 是各类别的样本数，total 是它们的总和
+double ID3::calculateEntropy(const int* counts, int numClasses, int total) const {
+	if (total == 0)
 		return 0.0;
 
-	map<string, int> labelCounts;
-	for (const auto& row : data) {
-		labelCounts[row[target_index]]++;
-	}
-
 	double entropy = 0.0;
-	double total = (double)data.size();
-
-	for (auto const& pair : labelCounts) {
-		double p = pair.second / total;
+	for (int k = 0; k < numClasses; ++k) {
+		if (counts[k] == 0)
+			continue;
+		double p = counts[k] / (double)total;
 		entropy -= p * log2(p);
 	}
 	return entropy;
 }
 
-// ȡѷ (Ϣ)
-int ID3::getBestAttribute(const vector<vector<string>>& data, const vector<bool>& usedAttributes) const {
-	double baseEntropy = calculateEntropy(data);
-	double maxGain = 0.0;
-	int bestAttr = -1;
+// 计算属性 attr 在 row_index[begin, end) 上的信息增益
+// 只扫描一遍行号，填充 取值 x 类别 的计数表，直接从计数表求条件熵，不复制任何行
+double ID3::calculateGain(int begin, int end, int attr, double baseEntropy, vector<int>& countTable, double& threshold) const {
+	const vector<int>& labels = dataset->column(target_index);
+	const vector<int>& column = dataset->column(attr);
+	const int numClasses = dataset->dictionary(target_index).size();
+	const int numValues = dataset->dictionary(attr).size();
+	const int total = end - begin;
+	const int* rows = row_index.data();
 
-	// ÿһ
-	for (int i = 0; i < attr_name.size(); ++i) {
-		// Ѿù(ĿѾ)
-		if (usedAttributes[i])
+	// 一次扫描填充计数表：countTable[取值 * 类别数 + 类别]
+	countTable.assign((size_t)numValues * numClasses, 0);
+	for (int i = begin; i < end; ++i) {
+		int r = rows[i];
+		countTable[column[r] * numClasses + labels[r]]++;
+	}
+
+	return splitGain(countTable.data(), attr, numClasses, total, baseEntropy, threshold);
+}
+
+// 从 取值 x 类别 的计数表求信息增益（训练和增量更新共用，保证两边的浮点结果完全相同）
+double ID3::gainFromCounts(const int* countTable, int numValues, int numClasses, int total, double baseEntropy) const {
+	// 累加条件熵: Sum ( Sv/S * H(Sv) )
+	double newEntropy = 0.0;
+	for (int v = 0; v < numValues; ++v) {
+		const int* valueCounts = countTable + (size_t)v * numClasses;
+		int valueTotal = 0;
+		for (int k = 0; k < numClasses; ++k)
+			valueTotal += valueCounts[k];
+		if (valueTotal == 0)
 			continue;
+		double prob = (double)valueTotal / total;
+		newEntropy += prob * calculateEntropy(valueCounts, numClasses, valueTotal);
+	}
 
-		// 
-		double newEntropy = 0.0;
-		map<string, vector<vector<string>>> subSets;
+	return baseEntropy - newEntropy;
+}
 
-		// յǰ i ֵʱ
-		for (const auto& row : data) {
-			subSets[row[i]].push_back(row);
+// 数值属性：左边的类别计数随扫描累加，右边 = 节点总计数 - 左边，每个切分点 O(类别数)
+double ID3::numericGainFromCounts(const int* countTable, int attr, int numClasses, int total, double baseEntropy, double& threshold) const {
+	const vector<int>& order = numeric_order[attr];
+	const vector<double>& values = numeric_values[attr];
+	vector<int> classTotals(numClasses, 0);
+	for (int code : order)
+		for (int k = 0; k < numClasses; ++k)
+			classTotals[k] += countTable[(size_t)code * numClasses + k];
+
+	vector<int> left(numClasses, 0);
+	vector<int> right(numClasses);
+	int leftTotal = 0;
+	double previous = 0;
+	double bestGain = 0.0;
+	threshold = 0;
+	for (int code : order) {
+		const int* valueCounts = countTable + (size_t)code * numClasses;
+		int valueTotal = 0;
+		for (int k = 0; k < numClasses; ++k)
+			valueTotal += valueCounts[k];
+		if (valueTotal == 0)
+			continue;
+
+		// 在上一个出现过的取值和这个取值之间切开（数值相同的编码不能分开）
+		if (leftTotal > 0 && values[code] != previous) {
+			for (int k = 0; k < numClasses; ++k)
+				right[k] = classTotals[k] - left[k];
+			double newEntropy = (double)leftTotal / total * calculateEntropy(left.data(), numClasses, leftTotal) +
+				(double)(total - leftTotal) / total * calculateEntropy(right.data(), numClasses, total - leftTotal);
+			double gain = baseEntropy - newEntropy;
+			if (gain > bestGain) {
+				bestGain = gain;
+				threshold = previous + (values[code] - previous) / 2;
+				if (!(threshold < values[code])) // 两数相邻到中点舍入成了右边的数
+					threshold = previous;
+			}
+		}
+		for (int k = 0; k < numClasses; ++k)
+			left[k] += valueCounts[k];
+		leftTotal += valueTotal;
+		previous = values[code];
+	}
+	return bestGain;
+}
+
+double ID3::splitGain(const int* countTable, int attr, int numClasses, int total, double baseEntropy, double& threshold) const {
+	if (numeric_attr[attr])
+		return numericGainFromCounts(countTable, attr, numClasses, total, baseEntropy, threshold);
+	threshold = 0;
+	return gainFromCounts(countTable, dictionary(attr).size(), numClasses, total, baseEntropy);
+}
+
+// 获取最佳分裂属性 (基于最大信息增益)
+int ID3::getBestAttribute(int begin, int end, int depth, const vector<bool>& usedAttributes, double& threshold) const {
+	const vector<int>& labels = dataset->column(target_index);
+	const int numClasses = dataset->dictionary(target_index).size();
+	const int total = end - begin;
+
+	// 根节点有预先统计好的计数时直接使用，不扫描任何列
+	const RootCounts* precomputed = depth == 0 ? root_counts : nullptr;
+
+	double baseEntropy;
+	if (precomputed) {
+		baseEntropy = calculateEntropy(precomputed->classCounts.data(), numClasses, total);
+	}
+	else {
+		ID3_PROFILE_SCOPE(profiler, PHASE_ENTROPY);
+		ID3_PROFILE_ROWS(profiler, total);
+		vector<int> classCounts(numClasses, 0);
+		for (int i = begin; i < end; ++i) {
+			classCounts[labels[row_index[i]]]++;
 		}
+		baseEntropy = calculateEntropy(classCounts.data(), numClasses, total);
+	}
+
+	// 候选属性：还没被用过的列(目标列已经被标记)
+	vector<int> candidates;
+	for (int i = 0; i < (int)attr_name.size(); ++i) {
+		if (!usedAttributes[i])
+			candidates.push_back(i);
+	}
 
-		// ۼ: Sum ( Sv/S * H(Sv) )
-		for (auto const& pair : subSets) {
-			double prob = (double)pair.second.size() / data.size();
-			newEntropy += prob * calculateEntropy(pair.second);
+	// 随机森林：只保留随机抽取的 feature_subset 个候选属性（部分洗牌），再按下标排序，平局规则不变
+	// 同一层的非空节点的行号段互不重叠，所以 (depth, begin) 唯一确定一个节点，抽样与构建顺序、线程数无关
+	if (feature_subset > 0 && (int)candidates.size() > feature_subset) {
+		SplitMix64 rng(((uint64_t)feature_seed << 32) ^ ((uint64_t)depth << 56) ^ ((uint64_t)begin * 0xD1B54A32D192ED03ULL));
+		for (int i = 0; i < feature_subset; ++i)
+			swap(candidates[i], candidates[i + rng.below((int)candidates.size() - i)]);
+		candidates.resize(feature_subset);
+		sort(candidates.begin(), candidates.end());
+	}
+
+	// 各属性的增益互相独立，先全部算出来再统一比较
+	// 工作量足够大时交给线程池并行计算，比较仍按属性下标顺序进行，所以结果与串行完全一致
+	// 计时放在整组属性外面而不是每个属性上，小节点上逐个计时的开销会超过计算本身
+	ID3_PROFILE_SCOPE(profiler, PHASE_GAIN);
+	ID3_PROFILE_ROWS(profiler, (long long)total * candidates.size());
+	vector<double> gains(candidates.size());
+	vector<double> thresholds(candidates.size());
+	if (precomputed) {
+		for (int c = 0; c < (int)candidates.size(); ++c)
+			gains[c] = splitGain(precomputed->tables[candidates[c]].data(), candidates[c], numClasses, total, baseEntropy, thresholds[c]);
+	}
+	else if (pool && (long long)total * candidates.size() >= PARALLEL_MIN_WORK) {
+		pool->parallelFor((int)candidates.size(), [&](int c) {
+			vector<int> countTable;
+			gains[c] = calculateGain(begin, end, candidates[c], baseEntropy, countTable, thresholds[c]);
+		});
+	}
+	else {
+		vector<int> countTable; // 在各属性之间复用，避免反复分配
+		for (int c = 0; c < (int)candidates.size(); ++c) {
+			gains[c] = calculateGain(begin, end, candidates[c], baseEntropy, countTable, thresholds[c]);
 		}
+	}
 
-		double gain = baseEntropy - newEntropy;
+	int bestAttr = chooseAttribute(candidates, gains);
+	if (bestAttr >= 0)
+		threshold = thresholds[find(candidates.begin(), candidates.end(), bestAttr) - candidates.begin()];
+	return bestAttr;
+}
 
-		// 
-		if (gain > maxGain) {
-			maxGain = gain;
-			bestAttr = i;
+// 在候选属性中选增益最大的，没有足够增益时返回 -1
+int ID3::chooseAttribute(const vector<int>& candidates, const vector<double>& gains) const {
+	double maxGain = 0.0;
+	int bestAttr = -1;
+	for (int c = 0; c < (int)candidates.size(); ++c) {
+		// 更新最大增益（严格大于，增益相同时保留下标较小的属性）
+		if (gains[c] > maxGain) {
+			maxGain = gains[c];
+			bestAttr = candidates[c];
 		}
 	}
 
-	// ̫С (Сֵ)Ϊûֶȣ -1
+	// 如果增益太小 (小于阈值)，认为没有区分度，返回 -1
 	if (maxGain < EPSILON)
 		return -1;
 
 	return bestAttr;
 }
 
-// ָ
-vector<vector<string>> ID3::splitData(const vector<vector<string>>& data, int axis, const string& value) const {
-	vector<vector<string>> subSet;
-	for (const auto& row : data) {
-		if (row[axis] == value) {
-			subSet.push_back(row);
+// 分割数据：类似快速排序的划分，但一次分成多路
+// 先统计每个编码的行数得到各段边界，再把放错段的行号逐个交换到所属段的写指针处，全程不分配新的行号数组
+vector<int> ID3::splitData(int begin, int end, int axis, double threshold) {
+	const vector<int>& column = dataset->column(axis);
+	ID3_PROFILE_SCOPE(profiler, PHASE_SPLIT);
+
+	// 数值属性只有两段，一次划分即可
+	if (numeric_attr[axis]) {
+		ID3_PROFILE_ROWS(profiler, end - begin);
+		const vector<double>& values = numeric_values[axis];
+		int mid = (int)(partition(row_index.begin() + begin, row_index.begin() + end,
+			[&](int r) { return values[column[r]] <= threshold; }) - row_index.begin());
+		return vector<int>{ begin, mid, end };
+	}
+
+	const int numValues = dataset->dictionary(axis).size();
+	ID3_PROFILE_ROWS(profiler, 2LL * (end - begin)); // 计数一遍，交换一遍
+
+	vector<int> bounds(numValues + 1, 0);
+	for (int i = begin; i < end; ++i) {
+		bounds[column[row_index[i]] + 1]++;
+	}
+	bounds[0] = begin;
+	for (int v = 0; v < numValues; ++v) {
+		bounds[v + 1] += bounds[v];
+	}
+
+	vector<int> next(bounds.begin(), bounds.end() - 1); // 每段的写指针
+	for (int v = 0; v < numValues; ++v) {
+		while (next[v] < bounds[v + 1]) {
+			int code = column[row_index[next[v]]];
+			if (code == v) {
+				next[v]++;
+			}
+			else {
+				swap(row_index[next[v]], row_index[next[code]]);
+				next[code]++;
+			}
 		}
 	}
-	return subSet;
+	return bounds;
 }
 
-// ȡ
-string ID3::getMajorityLabel(const vector<vector<string>>& data) const {
-	map<string, int> counts;
-	for (const auto& row : data) {
-		counts[row[target_index]]++;
+// 获取多数类（编码较小者优先，字典已排序时即与字符串字典序一致）
+int ID3::getMajorityLabel(int begin, int end) const {
+	const vector<int>& labels = dataset->column(target_index);
+	vector<int> counts(dataset->dictionary(target_index).size(), 0);
+	ID3_PROFILE_ROWS(profiler, end - begin);
+	for (int i = begin; i < end; ++i) {
+		counts[labels[row_index[i]]]++;
 	}
 
-	string majorityLabel;
+	int majorityLabel = -1;
 	int maxCount = -1;
-	for (auto const& pair : counts) {
-		if (pair.second > maxCount) {
-			maxCount = pair.second;
-			majorityLabel = pair.first;
+	for (int code = 0; code < (int)counts.size(); ++code) {
+		if (counts[code] > maxCount) {
+			maxCount = counts[code];
+			majorityLabel = code;
 		}
 	}
 	return majorityLabel;
 }
 
-// Ԥ⺯
-string ID3::predict(const vector<string>& sample) const {
+// 把 TreeNode 树按层序（BFS）展开成扁平数组
+// 同一节点的子节点在数组中连续存放，按取值编码排列，所以子节点下标 = next + 编码（数值属性为 next + 0 / 1）
+void ID3::compileTree() {
+	flat_nodes.clear();
+	if (!root)
+		return;
+
+	vector<const TreeNode*> order; // order[i] 是 flat_nodes[i] 对应的 TreeNode
+	order.push_back(root);
+	flat_nodes.push_back(FlatNode());
+
+	for (size_t i = 0; i < order.size(); ++i) {
+		const TreeNode* node = order[i];
+		FlatNode& flat = flat_nodes[i];
+		if (node->isLeaf) {
+			flat.attr = -1;
+			flat.next = node->label; // 空数据集的叶子没有类别，记为 -1
+			continue;
+		}
+
+		flat.attr = node->attr;
+		flat.next = (int)order.size();
+		flat.threshold = node->threshold;
+		for (int code = 0; code < branchCount(node->attr); ++code) {
+			order.push_back(node->children[code]);
+		}
+		flat_nodes.resize(order.size());
+	}
+
+	tree_nodes = flat_nodes.data();
+	tree_size = (int)flat_nodes.size();
+	resetEncoding();
+}
+
+// ---------------- 增量训练 ----------------
+
+// 内部节点的 counts：[类别计数 C 个][第 0 列的 取值 x 类别 表][第 1 列的表]...，目标列没有表
+// 叶子只有类别计数；计数都分配在 tree_arena 上
+void ID3::initStats() {
+	computeStatsLayout();
 	if (!root)
+		return;
+	allocateStats(root);
+	for (int r = 0; r < history.numRows(); ++r)
+		accumulateRow(root, r, false);
+}
+
+void ID3::computeStatsLayout() {
+	const size_t numClasses = dictionary(target_index).size();
+	stats_offset.assign(attr_name.size(), 0);
+	size_t offset = numClasses;
+	for (int j = 0; j < (int)attr_name.size(); ++j) {
+		stats_offset[j] = offset;
+		if (j != target_index)
+			offset += dictionary(j).size() * numClasses;
+	}
+	stats_size = offset;
+}
+
+void ID3::allocateStats(TreeNode* node) {
+	size_t size = node->isLeaf ? dictionary(target_index).size() : stats_size;
+	node->counts = tree_arena.createArray<int>(size);
+	fill(node->counts, node->counts + size, 0);
+	if (node->isLeaf)
+		return;
+	for (int code = 0; code < branchCount(node->attr); ++code)
+		allocateStats(node->children[code]);
+}
+
+void ID3::accumulateRow(TreeNode* node, int row, bool markDirty) {
+	const size_t numClasses = dictionary(target_index).size();
+	const int label = history.code(row, target_index);
+	while (true) {
+		if (markDirty)
+			node->dirty = true;
+		node->counts[label]++;
+		if (node->isLeaf)
+			return;
+		for (int j = 0; j < (int)attr_name.size(); ++j)
+			if (j != target_index)
+				node->counts[stats_offset[j] + history.code(row, j) * numClasses + label]++;
+		node = node->children[branchOf(node->attr, node->threshold, history.code(row, node->attr))];
+	}
+}
+
+bool ID3::update(const Dataset& rows) {
+	if (!incremental || !root) {
+		cerr << "错误: 模型不是增量训练的，不能增量更新" << endl;
+		return false;
+	}
+	if (feature_subset > 0) {
+		cerr << "错误: 随机抽取候选属性时不能增量更新" << endl;
+		return false;
+	}
+	for (const string& name : attr_name) {
+		if (rows.findAttribute(name) < 0) {
+			cerr << "错误: 新数据缺少列 " << name << endl;
+			return false;
+		}
+	}
+	if (rows.numRows() == 0)
+		return true;
+
+	Dataset encoded = rows.recode(attr_name, *attr_dicts);
+	bool unseen = false;
+	for (int j = 0; j < encoded.numAttributes() && !unseen; ++j)
+		for (int code : encoded.column(j))
+			if (code < 0) {
+				unseen = true;
+				break;
+			}
+
+	if (unseen) {
+		// 出现了新的取值：字典扩充后分支数和计数表的形状都变了，在全部数据上重新训练
+		vector<string> values(attr_name.size());
+		for (int r = 0; r < rows.numRows(); ++r) {
+			for (int j = 0; j < (int)attr_name.size(); ++j)
+				values[j] = rows.valueAt(r, rows.findAttribute(attr_name[j]));
+			history.appendRow(values);
+		}
+		history.sortDictionaries();
+		string target = attr_name[target_index]; // trainTree 会重写 attr_name，先复制一份
+		trainTree(history, target);
+		return true;
+	}
+
+	// 1. 新行沿路径累加计数，经过的节点标记为 dirty
+	const int first = history.numRows();
+	history.appendEncoded(encoded);
+	for (int r = first; r < history.numRows(); ++r)
+		accumulateRow(root, r, true);
+
+	// 2. 自顶向下重新判断 dirty 节点，最佳属性不变的只修改叶子的类别
+	vector<bool> usedAttributes(attr_name.size(), false);
+	usedAttributes[target_index] = true;
+	vector<PendingRebuild> rebuilds;
+	refreshNode(root, -1, 0, usedAttributes, rebuilds);
+
+	// 3. 重建最佳属性发生变化的子树，旧子树占的内存够多时整理
+	rebuildSubtrees(rebuilds);
+	compactTree();
+	compileTree();
+	return true;
+}
+
+void ID3::setLeaf(TreeNode* node, int label) {
+	node->isLeaf = true;
+	node->attr = -1;
+	node->children = nullptr;
+	node->label = label;
+}
+
+bool ID3::settleLeaf(TreeNode* node, const int* classCounts, int parentMajority, const vector<bool>& usedAttributes, int& total, int& majorityLabel) {
+	const int numClasses = (int)dictionary(target_index).size();
+	total = 0;
+	majorityLabel = -1;
+	int nonEmpty = 0;
+	for (int c = 0; c < numClasses; ++c) {
+		total += classCounts[c];
+		if (classCounts[c] > 0)
+			nonEmpty++;
+		if (majorityLabel < 0 || classCounts[c] > classCounts[majorityLabel])
+			majorityLabel = c;
+	}
+
+	// A. 空节点：父节点的多数类（根为 -1）
+	if (total == 0) {
+		setLeaf(node, parentMajority);
+		return true;
+	}
+	// B. 纯净
+	if (nonEmpty == 1) {
+		setLeaf(node, majorityLabel);
+		return true;
+	}
+	// C. 属性用完
+	for (bool u : usedAttributes)
+		if (!u)
+			return false;
+	setLeaf(node, majorityLabel);
+	return true;
+}
+
+int ID3::bestAttributeFromStats(const int* counts, int total, const vector<bool>& usedAttributes, double& threshold) const {
+	ID3_PROFILE_SCOPE(profiler, PHASE_GAIN);
+	const int numClasses = (int)dictionary(target_index).size();
+	double baseEntropy = calculateEntropy(counts, numClasses, total);
+	vector<int> candidates;
+	vector<double> gains;
+	vector<double> thresholds(attr_name.size(), 0);
+	for (int j = 0; j < (int)attr_name.size(); ++j) {
+		if (usedAttributes[j])
+			continue;
+		candidates.push_back(j);
+		gains.push_back(splitGain(counts + stats_offset[j], j, numClasses, total, baseEntropy, thresholds[j]));
+	}
+	int bestAttr = chooseAttribute(candidates, gains);
+	if (bestAttr >= 0)
+		threshold = thresholds[bestAttr];
+	return bestAttr;
+}
+
+// 与 buildTree 的判断顺序完全相同，只是统计量来自节点上的计数，而不是扫描行
+void ID3::refreshNode(TreeNode* node, int parentMajority, int depth, vector<bool>& usedAttributes, vector<PendingRebuild>& rebuilds) {
+	node->dirty = false;
+	const int numClasses = (int)dictionary(target_index).size();
+	const int* counts = node->counts;
+
+	// A、B、C. 空、纯净、属性用完
+	int total, majorityLabel;
+	if (settleLeaf(node, counts, parentMajority, usedAttributes, total, majorityLabel))
+		return;
+
+	// 叶子没有各属性的计数表，变得不纯以后只能从数据重建
+	if (node->isLeaf) {
+		rebuilds.push_back(PendingRebuild{ node, depth, usedAttributes, vector<int>() });
+		return;
+	}
+
+	// D. 用计数表重新选择最佳属性（数值属性的阈值变了也要重建）
+	double threshold = 0;
+	int bestAttrIndex = bestAttributeFromStats(counts, total, usedAttributes, threshold);
+	if (bestAttrIndex == -1) {
+		setLeaf(node, majorityLabel);
+		return;
+	}
+	const bool numeric = numeric_attr[bestAttrIndex] != 0;
+	if (bestAttrIndex != node->attr || (numeric && threshold != node->threshold)) {
+		rebuilds.push_back(PendingRebuild{ node, depth, usedAttributes, vector<int>() });
+		return;
+	}
+
+	// 分裂不变：有新行经过的子节点递归检查，没有样本的分支改为当前的多数类
+	if (!numeric)
+		usedAttributes[bestAttrIndex] = true;
+	for (int code = 0; code < branchCount(bestAttrIndex); ++code) {
+		TreeNode* child = node->children[code];
+		if (child->dirty)
+			refreshNode(child, majorityLabel, depth + 1, usedAttributes, rebuilds);
+		else if (child->isLeaf && all_of(child->counts, child->counts + numClasses, [](int n) { return n == 0; }))
+			child->label = majorityLabel;
+	}
+	if (!numeric)
+		usedAttributes[bestAttrIndex] = false;
+}
+
+// 扫描一遍 history，把每一行交给它路径上的待重建节点，然后逐个用 buildTree 重建
+// 被替换的旧子树暂时留在 Arena 里，由 compactTree 回收
+void ID3::rebuildSubtrees(vector<PendingRebuild>& rebuilds) {
+	if (rebuilds.empty())
+		return;
+
+	unordered_map<const TreeNode*, int> pending;
+	for (int i = 0; i < (int)rebuilds.size(); ++i)
+		pending[rebuilds[i].node] = i;
+
+	for (int r = 0; r < history.numRows(); ++r) {
+		const TreeNode* node = root;
+		while (true) {
+			auto it = pending.find(node);
+			if (it != pending.end()) {
+				rebuilds[it->second].rows.push_back(r);
+				break;
+			}
+			if (node->isLeaf)
+				break;
+			node = node->children[branchOf(node->attr, node->threshold, history.code(r, node->attr))];
+		}
+	}
+
+	if (thread_count > 1) {
+		pool.reset(new ThreadPool(thread_count));
+		tree_arena.setLanes(thread_count);
+	}
+	this->dataset = &history;
+	for (PendingRebuild& rebuild : rebuilds) {
+		row_index = move(rebuild.rows);
+		TreeNode* fresh = buildTree(0, (int)row_index.size(), rebuild.depth, rebuild.usedAttributes);
+		allocateStats(fresh);
+		for (int r : row_index)
+			accumulateRow(fresh, r, false);
+		*rebuild.node = *fresh;
+	}
+	this->dataset = nullptr;
+	pool.reset();
+	vector<int>().swap(row_index);
+}
+
+// 叶子只保留类别计数（由内部节点改成的叶子后面的计数表不再使用）
+size_t ID3::liveTreeBytes(const TreeNode* node) const {
+	size_t bytes = sizeof(TreeNode);
+	if (node->counts)
+		bytes += (node->isLeaf ? dictionary(target_index).size() : stats_size) * sizeof(int);
+	if (node->isLeaf)
+		return bytes;
+	const int numBranches = branchCount(node->attr);
+	bytes += numBranches * sizeof(TreeNode*);
+	for (int code = 0; code < numBranches; ++code)
+		bytes += liveTreeBytes(node->children[code]);
+	return bytes;
+}
+
+TreeNode* ID3::copyTree(const TreeNode* node, Arena& arena) const {
+	TreeNode* copy = arena.create<TreeNode>();
+	*copy = *node;
+	if (node->counts) {
+		size_t size = node->isLeaf ? dictionary(target_index).size() : stats_size;
+		copy->counts = arena.createArray<int>(size);
+		copy_n(node->counts, size, copy->counts);
+	}
+	if (node->isLeaf)
+		return copy;
+	const int numBranches = branchCount(node->attr);
+	copy->children = arena.createArray<TreeNode*>(numBranches);
+	for (int code = 0; code < numBranches; ++code)
+		copy->children[code] = copyTree(node->children[code], arena);
+	return copy;
+}
+
+void ID3::compactTree() {
+	const size_t live = liveTreeBytes(root);
+	const size_t reserved = tree_arena.bytesReserved();
+	if (reserved <= live || reserved - live < max(live, TREE_COMPACT_MIN_BYTES))
+		return;
+
+	Arena compact;
+	root = copyTree(root, compact);
+	tree_arena.swap(compact); // 旧的块随 compact 一起释放
+}
+
+// ---------------- 外存训练 ----------------
+
+bool ID3::trainOutOfCore(const string& cacheFile, const string& target) {
+	if (incremental) {
+		cerr << "错误: 增量模式需要在内存中保存训练数据，不能使用外存训练" << endl;
+		return false;
+	}
+	if (feature_subset > 0) {
+		cerr << "错误: 外存训练不支持随机抽取候选属性" << endl;
+		return false;
+	}
+	DatasetCacheReader reader;
+	if (!reader.open(cacheFile)) {
+		cerr << "错误: 无法读取缓存文件 " << cacheFile << endl;
+		return false;
+	}
+
+	ID3_PROFILE_BEGIN(profiler, trace_events);
+	bool ok;
+	{
+		ID3_PROFILE_SCOPE(profiler, PHASE_TRAIN);
+		history = Dataset();
+		ok = trainLevelWise(reader, target);
+	}
+	ID3_PROFILE_END(profiler, train_stats);
+	return ok;
+}
+
+// 按层构建：frontier 是这一层还需要统计的节点，它们的计数在同一遍扫描里累加，
+// 扫描后按计数逐个决定（与 buildTree 的判断相同），需要继续统计的子节点进入下一层
+bool ID3::trainLevelWise(DatasetCacheReader& reader, const string& target) {
+	vector<FrontierNode> frontier(1);
+	{
+		ID3_PROFILE_SCOPE(profiler, PHASE_METADATA);
+		if (!resetModel(reader.attributeNames(), target))
+			return false;
+		vector<ValueDictionary> dicts;
+		for (int j = 0; j < reader.numAttributes(); ++j)
+			dicts.push_back(reader.dictionary(j));
+		attr_dicts = make_shared<const vector<ValueDictionary>>(move(dicts));
+		setupNumeric(numeric_names);
+		computeStatsLayout();
+
+		root = tree_arena.create<TreeNode>();
+		frontier[0].node = root;
+		frontier[0].depth = 0;
+		frontier[0].usedAttributes.assign(attr_name.size(), false);
+		frontier[0].usedAttributes[target_index] = true;
+	}
+
+	if (thread_count > 1)
+		pool.reset(new ThreadPool(thread_count));
+
+	// 计数表只在一层之内有效，每组扫描完就整体释放
+	Arena tableArena;
+	const size_t groupSize = max<size_t>(1, OUT_OF_CORE_TABLE_BYTES / (stats_size * sizeof(int)));
+	bool ok = true;
+	while (ok && !frontier.empty()) {
+		vector<FrontierNode> next;
+		// 计数表超过上限时，这一层分成几组，每组扫描一遍
+		for (size_t first = 0; ok && first < frontier.size(); first += groupSize) {
+			size_t last = min(frontier.size(), first + groupSize);
+			tableArena.clear();
+			for (size_t i = first; i < last; ++i)
+				frontier[i].node->counts = tableArena.createArray<int>(stats_size);
+
+			ok = scanLevel(reader);
+			for (size_t i = first; ok && i < last; ++i)
+				expandNode(frontier[i], next);
+			for (size_t i = first; i < last; ++i)
+				frontier[i].node->counts = nullptr;
+		}
+		frontier.swap(next);
+	}
+	pool.reset();
+
+	if (!ok) {
+		cerr << "错误: 读取缓存文件失败" << endl;
+		destroyTree();
+		return false;
+	}
+
+	ID3_PROFILE_SCOPE(profiler, PHASE_COMPILE);
+	compileTree();
+	return true;
+}
+
+bool ID3::scanLevel(DatasetCacheReader& reader) {
+	const size_t numClasses = dictionary(target_index).size();
+	const int numCols = (int)attr_name.size();
+	vector<vector<int>> columns;
+	vector<int*> slots;
+
+	for (int first = 0; first < reader.numRows(); first += OUT_OF_CORE_CHUNK_ROWS) {
+		const int count = min(OUT_OF_CORE_CHUNK_ROWS, reader.numRows() - first);
+		if (!reader.readRows(first, count, columns))
+			return false;
+		ID3_PROFILE_ROWS(profiler, count);
+
+		// 1. 每行沿已经确定的分裂走到所在的待统计节点，slots[r] 指向它的计数（落在叶子或不在本组的为空）
+		ID3_PROFILE_SCOPE(profiler, PHASE_SPLIT);
+		slots.resize(count);
+		auto route = [&](int block) {
+			const int end = min(count, (block + 1) * TASK_MIN_ROWS);
+			for (int r = block * TASK_MIN_ROWS; r < end; ++r) {
+				const TreeNode* node = root;
+				while (!node->isLeaf && node->children)
+					node = node->children[branchOf(node->attr, node->threshold, columns[node->attr][r])];
+				slots[r] = node->isLeaf ? nullptr : node->counts;
+			}
+		};
+
+		// 2. 按列累加：每列只写各节点中自己的那张计数表，列之间可以并行
+		const vector<int>& labels = columns[target_index];
+		auto accumulate = [&](int j) {
+			if (j == target_index) {
+				for (int r = 0; r < count; ++r)
+					if (slots[r])
+						slots[r][labels[r]]++;
+				return;
+			}
+			const vector<int>& codes = columns[j];
+			const size_t offset = stats_offset[j];
+			for (int r = 0; r < count; ++r)
+				if (slots[r])
+					slots[r][offset + codes[r] * numClasses + labels[r]]++;
+		};
+
+		const int blocks = (count + TASK_MIN_ROWS - 1) / TASK_MIN_ROWS;
+		if (pool) {
+			pool->parallelFor(blocks, route);
+			pool->parallelFor(numCols, accumulate);
+		}
+		else {
+			for (int b = 0; b < blocks; ++b)
+				route(b);
+			for (int j = 0; j < numCols; ++j)
+				accumulate(j);
+		}
+	}
+	return true;
+}
+
+void ID3::expandNode(FrontierNode& frontier, vector<FrontierNode>& next) {
+	TreeNode* node = frontier.node;
+	const int* counts = node->counts;
+	const int numClasses = (int)dictionary(target_index).size();
+	vector<bool>& usedAttributes = frontier.usedAttributes;
+	ID3_PROFILE_NODE(profiler, frontier.depth);
+
+	// 只有根可能为空，它的叶子类别为 -1
+	int total, majorityLabel;
+	if (settleLeaf(node, counts, -1, usedAttributes, total, majorityLabel))
+		return;
+
+	double threshold = 0;
+	int bestAttrIndex = bestAttributeFromStats(counts, total, usedAttributes, threshold);
+	if (bestAttrIndex == -1) {
+		setLeaf(node, majorityLabel);
+		return;
+	}
+
+	const int numValues = dictionary(bestAttrIndex).size();
+	const int numBranches = branchCount(bestAttrIndex);
+	const bool numeric = numeric_attr[bestAttrIndex] != 0;
+	node->attr = bestAttrIndex;
+	node->threshold = threshold;
+	node->children = tree_arena.createArray<TreeNode*>(numBranches);
+
+	// 子节点的类别计数是父节点计数表中落到该分支的各行之和（分类属性就是对应的一行），
+	// 空、纯净、属性用完的子节点当场成为叶子
+	const int* table = counts + stats_offset[bestAttrIndex];
+	vector<int> branchCounts((size_t)numBranches * numClasses, 0);
+	for (int code = 0; code < numValues; ++code) {
+		int* dst = branchCounts.data() + (size_t)branchOf(bestAttrIndex, threshold, code) * numClasses;
+		for (int k = 0; k < numClasses; ++k)
+			dst[k] += table[(size_t)code * numClasses + k];
+	}
+
+	if (!numeric)
+		usedAttributes[bestAttrIndex] = true;
+	for (int code = 0; code < numBranches; ++code) {
+		TreeNode* child = tree_arena.create<TreeNode>();
+		node->children[code] = child;
+		int childTotal, childMajority;
+		if (settleLeaf(child, branchCounts.data() + (size_t)code * numClasses, majorityLabel, usedAttributes, childTotal, childMajority))
+			ID3_PROFILE_NODE(profiler, frontier.depth + 1);
+		else
+			next.push_back(FrontierNode{ child, frontier.depth + 1, usedAttributes });
+	}
+	if (!numeric)
+		usedAttributes[bestAttrIndex] = false;
+}
+
+// ---------------- 后剪枝 ----------------
+
+// 推理树按层序排列，子节点总在父节点之后，所以一遍顺序扫描就能求出各节点的深度
+int ID3::treeDepth() const {
+	if (tree_size == 0)
+		return -1;
+	vector<int> depth(tree_size, 0);
+	int maxDepth = 0;
+	for (int i = 0; i < tree_size; ++i) {
+		maxDepth = max(maxDepth, depth[i]);
+		for (int b = 0; b < flatBranches(i); ++b)
+			depth[tree_nodes[i].next + b] = depth[i] + 1;
+	}
+	return maxDepth;
+}
+
+size_t ID3::modelBytes() const {
+	return (size_t)tree_size * sizeof(FlatNode);
+}
+
+bool ID3::canPrune(const Dataset& data) const {
+	if (tree_size == 0) {
+		cerr << "错误: 模型还没有训练，无法剪枝" << endl;
+		return false;
+	}
+	if (incremental) {
+		cerr << "错误: 增量模式的模型不能剪枝" << endl;
+		return false;
+	}
+	if (data.findAttribute(attr_name[target_index]) < 0) {
+		cerr << "错误: 剪枝用的数据中没有目标列 " << attr_name[target_index] << endl;
+		return false;
+	}
+	return true;
+}
+
+long long ID3::routeCounts(const Dataset& encoded, vector<int>& counts, vector<int>* stuck) const {
+	const int numClasses = dictionary(target_index).size();
+	const vector<int>& labels = encoded.column(target_index);
+	counts.assign((size_t)tree_size * numClasses, 0);
+	if (stuck)
+		stuck->assign(tree_size, 0);
+
+	long long visits = 0;
+	for (int r = 0; r < encoded.numRows(); ++r) {
+		const int label = labels[r];
+		if ((unsigned)label >= (unsigned)numClasses)
+			continue;
+		int index = 0;
+		while (true) {
+			counts[(size_t)index * numClasses + label]++;
+			++visits;
+			const FlatNode& node = tree_nodes[index];
+			if (node.attr < 0)
+				break;
+			const int code = encoded.code(r, node.attr);
+			if ((unsigned)code >= (unsigned)code_limit[node.attr]) {
+				if (stuck)
+					(*stuck)[index]++;
+				break;
+			}
+			index = node.next + branchOf(node.attr, node.threshold, code);
+		}
+	}
+	return visits;
+}
+
+// 多数类的平局规则与 getMajorityLabel 相同（编码较小者优先），所以与训练时同一节点的多数类一致
+vector<int> ID3::pruneLabels(const vector<int>& counts) const {
+	const int numClasses = dictionary(target_index).size();
+	vector<int> labels(tree_size, -1);
+	for (int i = 0; i < tree_size; ++i) {
+		const int* nodeCounts = counts.data() + (size_t)i * numClasses;
+		int maxCount = 0;
+		for (int k = 0; k < numClasses; ++k) {
+			if (nodeCounts[k] > maxCount) {
+				maxCount = nodeCounts[k];
+				labels[i] = k;
+			}
+		}
+		// 子节点先继承这个类别，它自己有行经过时再被覆盖
+		for (int b = 0; b < flatBranches(i); ++b)
+			labels[tree_nodes[i].next + b] = labels[i];
+	}
+	return labels;
+}
+
+void ID3::measureTree(const Dataset& reference, int& nodes, int& depth, size_t& bytes, double& path) const {
+	nodes = tree_size;
+	depth = treeDepth();
+	bytes = modelBytes();
+	vector<int> counts;
+	long long visits = routeCounts(reference, counts, nullptr);
+	long long rows = 0;
+	for (int k = 0; k < dictionary(target_index).size(); ++k)
+		rows += counts[k];
+	path = rows > 0 ? (double)visits / rows : 0.0;
+}
+
+// 与 compileTree 相同的层序展开，只是遇到 collapse 的节点就输出叶子、不再展开它的子树
+int ID3::applyPrune(const vector<char>& collapse, const vector<int>& labels) {
+	vector<FlatNode> pruned(1);
+	vector<int> order(1, 0); // order[i] 是 pruned[i] 对应的旧节点
+	int collapsed = 0;
+	for (size_t i = 0; i < order.size(); ++i) {
+		const int old = order[i];
+		const FlatNode& node = tree_nodes[old];
+		if (node.attr < 0 || collapse[old]) {
+			pruned[i].attr = -1;
+			pruned[i].next = node.attr < 0 ? node.next : labels[old];
+			collapsed += node.attr >= 0;
+			continue;
+		}
+		pruned[i] = node;
+		pruned[i].next = (int)order.size();
+		for (int b = 0; b < flatBranches(old); ++b)
+			order.push_back(node.next + b);
+		pruned.resize(order.size());
+	}
+
+	flat_nodes.swap(pruned);
+	tree_nodes = flat_nodes.data();
+	tree_size = (int)flat_nodes.size();
+	model_file.reset();  // load 得到的节点区不再使用
+	destroyTree();       // 训练树与剪枝后的推理树不再对应
+	resetEncoding();
+	return collapsed;
+}
+
+// 减少错误剪枝：errors[i] 是（已经剪过的）i 的子树在验证集上的错误数，从叶子往上算；
+// 停在 i 上（遇到没见过的取值）的验证行无法预测，算作子树的错误，换成叶子后它们也能得到预测
+bool ID3::pruneReducedError(const Dataset& training, const Dataset& validation, PruneStats* stats) {
+	if (!canPrune(training) || !canPrune(validation))
+		return false;
+
+	const int numClasses = dictionary(target_index).size();
+	Dataset encodedTraining = encodeBatch(training);
+	Dataset encodedValidation = encodeBatch(validation);
+	if (stats)
+		measureTree(encodedValidation, stats->nodesBefore, stats->depthBefore, stats->bytesBefore, stats->pathBefore);
+
+	vector<int> trainCounts, validCounts, stuck;
+	routeCounts(encodedTraining, trainCounts, nullptr);
+	routeCounts(encodedValidation, validCounts, &stuck);
+	vector<int> labels = pruneLabels(trainCounts);
+
+	vector<long long> errors(tree_size, 0);
+	vector<char> collapse(tree_size, 0);
+	for (int i = tree_size - 1; i >= 0; --i) {
+		const int* nodeCounts = validCounts.data() + (size_t)i * numClasses;
+		long long reached = 0;
+		for (int k = 0; k < numClasses; ++k)
+			reached += nodeCounts[k];
+
+		const bool leaf = tree_nodes[i].attr < 0;
+		const int label = leaf ? tree_nodes[i].next : labels[i];
+		const long long asLeaf = reached - (label >= 0 ? nodeCounts[label] : 0);
+		if (leaf) {
+			errors[i] = asLeaf;
+			continue;
+		}
+
+		long long subtree = stuck[i];
+		for (int b = 0; b < flatBranches(i); ++b)
+			subtree += errors[tree_nodes[i].next + b];
+		// 不比原来差就剪，剪掉的子树越多越好
+		collapse[i] = asLeaf <= subtree;
+		errors[i] = min(asLeaf, subtree);
+	}
+
+	int pruned = applyPrune(collapse, labels);
+	if (stats) {
+		stats->subtreesPruned = pruned;
+		measureTree(encodedValidation, stats->nodesAfter, stats->depthAfter, stats->bytesAfter, stats->pathAfter);
+	}
+	return true;
+}
+
+// 悲观剪枝：先从叶子往上求出原树每个子树的叶子数和训练错误数，
+// 再对每个内部节点比较 换成叶子的错误 + 修正 与 子树的错误 + 每叶修正 + 一个标准差；
+// 各节点的判断只依赖原树，所以顺序无关，被祖先剪掉的节点上的判断不起作用
+bool ID3::prunePessimistic(const Dataset& training, PruneStats* stats) {
+	if (!canPrune(training))
+		return false;
+
+	const int numClasses = dictionary(target_index).size();
+	Dataset encoded = encodeBatch(training);
+	if (stats)
+		measureTree(encoded, stats->nodesBefore, stats->depthBefore, stats->bytesBefore, stats->pathBefore);
+
+	vector<int> counts;
+	routeCounts(encoded, counts, nullptr);
+	vector<int> labels = pruneLabels(counts);
+
+	vector<long long> reached(tree_size, 0);
+	vector<long long> leafErrors(tree_size, 0);
+	vector<int> leaves(tree_size, 0);
+	for (int i = tree_size - 1; i >= 0; --i) {
+		const int* nodeCounts = counts.data() + (size_t)i * numClasses;
+		for (int k = 0; k < numClasses; ++k)
+			reached[i] += nodeCounts[k];
+		if (tree_nodes[i].attr < 0) {
+			const int label = tree_nodes[i].next;
+			leafErrors[i] = reached[i] - (label >= 0 ? nodeCounts[label] : 0);
+			leaves[i] = 1;
+			continue;
+		}
+		for (int b = 0; b < flatBranches(i); ++b) {
+			leafErrors[i] += leafErrors[tree_nodes[i].next + b];
+			leaves[i] += leaves[tree_nodes[i].next + b];
+		}
+	}
+
+	vector<char> collapse(tree_size, 0);
+	for (int i = 0; i < tree_size; ++i) {
+		if (tree_nodes[i].attr < 0)
+			continue;
+		const double n = (double)reached[i];
+		const double asLeaf = (labels[i] >= 0 ? n - counts[(size_t)i * numClasses + labels[i]] : 0) + PESSIMISTIC_LEAF_PENALTY;
+		const double subtree = leafErrors[i] + PESSIMISTIC_LEAF_PENALTY * leaves[i];
+		const double se = subtree < n ? sqrt(subtree * (n - subtree) / n) : 0.0;
+		collapse[i] = asLeaf <= subtree + se;
+	}
+
+	int pruned = applyPrune(collapse, labels);
+	if (stats) {
+		stats->subtreesPruned = pruned;
+		measureTree(encoded, stats->nodesAfter, stats->depthAfter, stats->bytesAfter, stats->pathAfter);
+	}
+	return true;
+}
+
+// 预测函数（编码样本）：codes[j] 是第 j 列按模型编码（encodeValue）的结果，返回类别编码
+// 遇到训练时没见过的取值（编码为 -1 或越界）返回 -1
+int ID3::predictCode(const int* codes) const {
+	if (tree_size == 0)
+		return -1;
+
+	const FlatNode* nodes = tree_nodes;
+	const FlatNode* node = nodes;
+	while (node->attr >= 0) {
+		int code = codes[node->attr];
+		if ((unsigned)code >= (unsigned)code_limit[node->attr])
+			return -1;
+		node = nodes + node->next + branchOf(node->attr, node->threshold, code);
+	}
+	return node->next;
+}
+
+int ID3::predictRow(const Dataset& block, int row) const {
+	if (tree_size == 0)
+		return -1;
+
+	const FlatNode* nodes = tree_nodes;
+	const FlatNode* node = nodes;
+	while (node->attr >= 0) {
+		int code = block.code(row, node->attr);
+		if ((unsigned)code >= (unsigned)code_limit[node->attr])
+			return -1;
+		node = nodes + node->next + branchOf(node->attr, node->threshold, code);
+	}
+	return node->next;
+}
+
+// 把任意编码的数据集换成模型训练时的编码，供 predictBatch 使用
+Dataset ID3::encodeBatch(const Dataset& data) const {
+	// 数值属性的字典后面接上各阈值区间，编码 字典大小 + k 在结果里也有对应的取值
+	vector<ValueDictionary> dicts(*attr_dicts);
+	for (int j = 0; j < (int)numeric_cells.size(); ++j) {
+		if (!numeric_attr[j])
+			continue;
+		for (int k = 0; k <= (int)numeric_cells[j].size(); ++k)
+			dicts[j].intern(cellName(j, k));
+	}
+	return data.recode(attr_name, dicts, [this](int col, const string& value) { return encodeValue(col, value); });
+}
+
+int ID3::encodeValue(int col, const string& value) const {
+	int code = dictionary(col).find(value);
+	double number;
+	if (code < 0 && col < (int)numeric_cells.size() && numeric_attr[col] && parseNumber(value, number)) {
+		const vector<double>& cells = numeric_cells[col];
+		code = dictionary(col).size() + (int)(lower_bound(cells.begin(), cells.end(), number) - cells.begin());
+	}
+	return code;
+}
+
+string ID3::cellName(int col, int k) const {
+	const vector<double>& cells = numeric_cells[col];
+	string lower = k == 0 ? "-inf" : numberText(cells[k - 1]);
+	string upper = k == (int)cells.size() ? "+inf)" : numberText(cells[k]) + "]";
+	return "(" + lower + ", " + upper;
+}
+
+// 按 BATCH_TILE 行一组逐层推进，count 行的结果写到 out；codeOf(i, attr) 是第 i 行在 attr 列的编码
+// numValues[j] 是各列的有效编码数，values[j] 是数值属性各编码对应的数（分类属性为空）
+template <typename CodeOf>
+static void predictTiles(const FlatNode* nodes, const int* numValues, const double* const* values, int count, int* out, CodeOf codeOf) {
+	int current[BATCH_TILE];
+	int active[BATCH_TILE];
+	for (int base = 0; base < count; base += BATCH_TILE) {
+		int tile = min(BATCH_TILE, count - base);
+		int numActive = tile;
+		for (int i = 0; i < tile; ++i) {
+			current[i] = 0;
+			active[i] = i;
+		}
+
+		while (numActive > 0) {
+			int kept = 0;
+			for (int k = 0; k < numActive; ++k) {
+				int i = active[k];
+				const FlatNode& node = nodes[current[i]];
+				if (node.attr < 0) {
+					out[base + i] = node.next;
+					continue;
+				}
+				int code = codeOf(base + i, node.attr);
+				if ((unsigned)code >= (unsigned)numValues[node.attr]) {
+					out[base + i] = -1; // 没见过的取值
+					continue;
+				}
+				if (values[node.attr])
+					code = values[node.attr][code] > node.threshold ? 1 : 0;
+				current[i] = node.next + code;
+				active[kept++] = i;
+			}
+			numActive = kept;
+		}
+	}
+}
+
+// 批量预测：block 使用模型的编码（训练集本身，或者 encodeBatch 的结果），返回每行的类别编码，无法预测的行为 -1
+// 按 BATCH_TILE 行一组逐层推进：同一层里连续处理一组行，各行的访存互不依赖，可以重叠等待；
+// 支持 AVX2 时每 8 行用一组向量寄存器，节点数组上的 attr / next 用 gather 读取，叶子和越界判断用向量比较完成
+// 数值属性的编码先查出对应的数再与阈值比较，换成 0 / 1 的分支号，之后与分类属性走同样的路径
+vector<int> ID3::predictBatch(const Dataset& block) const {
+	vector<int> result(block.numRows(), -1);
+	predictBatch(block, 0, block.numRows(), result.data());
+	return result;
+}
+
+void ID3::predictBatch(const Dataset& block, int begin, int end, int* out) const {
+	if (tree_size == 0 || begin >= end) {
+		fill(out, out + max(0, end - begin), -1);
+		return;
+	}
+
+	const int numAttrs = (int)attr_name.size();
+	vector<const int*> columns(numAttrs);
+	vector<int> numValues(numAttrs);
+	vector<const double*> values(numAttrs); // 数值属性各编码对应的数，分类属性为空
+	for (int j = 0; j < numAttrs; ++j) {
+		columns[j] = block.column(j).data();
+		numValues[j] = code_limit[j];
+		values[j] = numeric_attr[j] ? numeric_values[j].data() : nullptr;
+	}
+	const FlatNode* nodes = tree_nodes;
+
+	int start = begin;
+#if defined(__AVX2__)
+	const __m256i laneBits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+	const __m256i minusOne = _mm256_set1_epi32(-1);
+	const int* nodeAttr = &nodes[0].attr;
+	const int* nodeNext = &nodes[0].next;
+	alignas(32) int attrs[8];
+	alignas(32) int codes[8];
+	alignas(32) int nodeIds[8];
+
+	for (; start + 8 <= end; start += 8) {
+		__m256i node = _mm256_setzero_si256();
+		__m256i labels = minusOne;
+		int live = 0xFF; // 还在树中行走的行
+
+		while (true) {
+			// FlatNode 是 16 字节，gather 的比例因子最大为 8，所以下标乘 2
+			__m256i slot = _mm256_slli_epi32(node, 1);
+			__m256i attr = _mm256_i32gather_epi32(nodeAttr, slot, 8);
+			__m256i next = _mm256_i32gather_epi32(nodeNext, slot, 8);
+
+			// 到达叶子的行记下类别
+			__m256i leaf = _mm256_cmpgt_epi32(_mm256_setzero_si256(), attr);
+			int leafMask = _mm256_movemask_ps(_mm256_castsi256_ps(leaf)) & live;
+			if (leafMask) {
+				__m256i take = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(leafMask), laneBits), laneBits);
+				labels = _mm256_blendv_epi8(labels, next, take);
+				live &= ~leafMask;
+			}
+			if (!live)
+				break;
+
+			// 各行分裂属性不同，取值来自不同列，这一步逐行读取（叶子行的属性按 0 号列读，结果不会被使用）
+			// 数值属性的有效编码在这里换成分支号 0 / 1，它小于取值数，不影响下面的越界判断
+			__m256i safeAttr = _mm256_max_epi32(attr, _mm256_setzero_si256());
+			_mm256_store_si256((__m256i*)attrs, safeAttr);
+			_mm256_store_si256((__m256i*)nodeIds, node);
+			for (int l = 0; l < 8; ++l) {
+				int a = attrs[l];
+				int c = columns[a][start + l];
+				if (values[a] && (unsigned)c < (unsigned)numValues[a])
+					c = values[a][c] > nodes[nodeIds[l]].threshold ? 1 : 0;
+				codes[l] = c;
+			}
+			__m256i code = _mm256_load_si256((const __m256i*)codes);
+
+			// 编码越界（训练时没见过的取值）的行停在这里，结果保持 -1
+			__m256i limit = _mm256_i32gather_epi32(numValues.data(), safeAttr, sizeof(int));
+			__m256i valid = _mm256_and_si256(_mm256_cmpgt_epi32(code, minusOne), _mm256_cmpgt_epi32(limit, code));
+			live &= _mm256_movemask_ps(_mm256_castsi256_ps(valid));
+			if (!live)
+				break;
+
+			__m256i liveLanes = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(live), laneBits), laneBits);
+			node = _mm256_blendv_epi8(node, _mm256_add_epi32(next, code), liveLanes);
+		}
+
+		_mm256_storeu_si256((__m256i*)(out + (start - begin)), labels);
+	}
+#endif
+
+	// 标量路径（以及 AVX2 处理后剩下的不足 8 行）
+	predictTiles(nodes, numValues.data(), values.data(), end - start, out + (start - begin),
+		[&](int i, int attr) { return columns[attr][start + i]; });
+}
+
+void ID3::predictBatch(const int* codes, int numRows, int* out) const {
+	if (tree_size == 0) {
+		fill(out, out + max(0, numRows), -1);
+		return;
+	}
+
+	const int numAttrs = (int)attr_name.size();
+	vector<int> numValues(numAttrs);
+	vector<const double*> values(numAttrs);
+	for (int j = 0; j < numAttrs; ++j) {
+		numValues[j] = code_limit[j];
+		values[j] = numeric_attr[j] ? numeric_values[j].data() : nullptr;
+	}
+	predictTiles(tree_nodes, numValues.data(), values.data(), numRows, out,
+		[&](int i, int attr) { return codes[(size_t)i * numAttrs + attr]; });
+}
+
+// 预测函数
+string ID3::predict(const vector<string>& sample) const {
+	if (tree_size == 0)
 		return "Empty Tree";
 	if (sample.size() > attr_name.size())
 	{
-		return "Լά";
+		return "测试集的维数错误";
 	}
 
-	TreeNode* currentNode = root;
+	const FlatNode* nodes = tree_nodes;
+	const FlatNode* node = nodes;
 
-	while (!currentNode->isLeaf) {
-		string attrName = currentNode->Attribute;
+	while (node->attr >= 0) {
+		const string& val = sample[node->attr];
+		// 数值属性直接按数值比较，不需要在字典里
+		double number;
+		if (numeric_attr[node->attr] && parseNumber(val, number)) {
+			node = nodes + node->next + (number > node->threshold ? 1 : 0);
+			continue;
+		}
 
-		// ҵ sample еλ
-		if (attr_index_map.find(attrName) == attr_index_map.end()) {
-			return "Error: δ֪";
+		// 只在路径上的属性处查一次字典，把取值转为编码
+		int code = dictionary(node->attr).find(val);
+		if (code < 0) {
+			// 遇到训练集中没见过的特征值，无法继续走
+			// 简单的策略：返回未知，或者这里可以做得更复杂(比如返回父节点多数类)
+			return "未知的特征值: " + val;
 		}
-		int idx = attr_index_map.at(attrName);
-		string val = sample[idx];
+		node = nodes + node->next + branchOf(node->attr, node->threshold, code);
+	}
+
+	if (node->next < 0)
+		return "数据集是空的";
+	return dictionary(target_index).value(node->next);
+}
+
+// 保存模型：节点数组原样写出，加载时可以直接映射使用
+bool ID3::save(const string& filename) const {
+	if (tree_size == 0) {
+		cerr << "错误: 模型还没有训练，无法保存" << endl;
+		return false;
+	}
+
+	FILE* f = fopen(filename.c_str(), "wb");
+	if (!f) {
+		cerr << "错误: 无法写入模型文件 " << filename << endl;
+		return false;
+	}
+
+	const unsigned long long dictOffset = MODEL_HEADER_SIZE + (unsigned long long)tree_size * sizeof(FlatNode);
+	fwrite(MODEL_MAGIC, 1, 4, f);
+	writeU32(f, MODEL_FILE_VERSION);
+	writeU32(f, (unsigned int)attr_name.size());
+	writeU32(f, (unsigned int)target_index);
+	writeU32(f, (unsigned int)tree_size);
+	writeU32(f, 0);
+	writeU64(f, dictOffset);
+
+	fwrite(tree_nodes, sizeof(FlatNode), tree_size, f);
+
+	for (size_t j = 0; j < attr_name.size(); ++j) {
+		writeString(f, attr_name[j]);
+		writeU32(f, numeric_attr[j] ? 1 : 0);
+		writeU32(f, (unsigned int)dictionary(j).size());
+		for (const string& v : dictionary(j).allValues())
+			writeString(f, v);
+	}
 
-		// ҶӦӽڵ
-		if (currentNode->children.find(val) == currentNode->children.end()) {
-			// ѵûֵ޷
-			// 򵥵Ĳԣδ֪ø(緵ظڵ)
-			return "δֵ֪: " + val;
+	bool ok = !ferror(f);
+	fclose(f);
+	if (!ok)
+		remove(filename.c_str());
+	return ok;
+}
+
+// 加载模型：先完整校验，全部通过后才替换当前模型
+bool ID3::load(const string& filename) {
+	unique_ptr<MappedFile> file(new MappedFile());
+	if (!file->open(filename) || file->size() < MODEL_HEADER_SIZE)
+		return false;
+
+	const char* base = file->data();
+	const size_t size = file->size();
+	if (memcmp(base, MODEL_MAGIC, 4) != 0)
+		return false;
+
+	BinaryCursor cursor(base, size, 4);
+	unsigned int version, numAttrs, target, numNodes, reserved;
+	unsigned long long dictOffset;
+	if (!cursor.readU32(version) || version != MODEL_FILE_VERSION)
+		return false;
+	if (!cursor.readU32(numAttrs) || !cursor.readU32(target) || !cursor.readU32(numNodes) ||
+		!cursor.readU32(reserved) || !cursor.readU64(dictOffset))
+		return false;
+	if (target >= numAttrs || numNodes == 0 ||
+		dictOffset != MODEL_HEADER_SIZE + (unsigned long long)numNodes * sizeof(FlatNode) || dictOffset > size)
+		return false;
+	// 每列在字典区至少占 12 字节（列名长度、是否数值、取值数），放不下的属性数说明文件损坏，不能先按它分配
+	if (numAttrs > (size - dictOffset) / 12)
+		return false;
+
+	// 1. 列名和字典
+	vector<string> names(numAttrs);
+	vector<string> numericNames;
+	vector<char> numericCols(numAttrs, 0);
+	vector<ValueDictionary> dicts(numAttrs);
+	BinaryCursor dictCursor(base, size, dictOffset);
+	for (unsigned int j = 0; j < numAttrs; ++j) {
+		StringRef ref;
+		unsigned int numeric, dictSize;
+		if (!dictCursor.readRef(ref) || !dictCursor.readU32(numeric) || !dictCursor.readU32(dictSize) || numeric > 1)
+			return false;
+		names[j].assign(ref.data, ref.size);
+		if (numeric)
+			numericNames.push_back(names[j]);
+		numericCols[j] = (char)numeric;
+		for (unsigned int code = 0; code < dictSize; ++code) {
+			double number;
+			if (!dictCursor.readRef(ref) || (numeric && !parseNumber(string(ref.data, ref.size), number)))
+				return false;
+			// 编码按顺序写入，重复的取值会被合并，导致后续编码整体错位
+			if (dicts[j].intern(ref.data, ref.size) != (int)code)
+				return false;
 		}
+	}
 
-		currentNode = currentNode->children.at(val);
+	// 2. 校验节点：子节点必须排在父节点之后（层序），保证预测时不会越界或死循环
+	const FlatNode* nodes = (const FlatNode*)(base + MODEL_HEADER_SIZE);
+	const int numLabels = dicts[target].size();
+	for (unsigned int i = 0; i < numNodes; ++i) {
+		const FlatNode& node = nodes[i];
+		if (node.attr < 0) {
+			if (node.attr != -1 || node.next < -1 || node.next >= numLabels)
+				return false;
+			continue;
+		}
+		if ((unsigned)node.attr >= numAttrs || (unsigned)node.attr == target || node.next <= (int)i)
+			return false;
+		int branches = numericCols[node.attr] ? 2 : dicts[node.attr].size();
+		if ((long long)node.next + branches > numNodes)
+			return false;
 	}
 
-	return currentNode->label;
+	// 3. 替换当前模型，节点数组直接使用映射的内存
+	destroyTree();
+	flat_nodes.clear();
+	attr_name = names;
+	attr_dicts = make_shared<const vector<ValueDictionary>>(move(dicts));
+	target_index = (int)target;
+	attr_index_map.clear();
+	for (unsigned int j = 0; j < numAttrs; ++j)
+		attr_index_map[attr_name[j]] = (int)j;
+	setupNumeric(numericNames);
+	model_file = move(file);
+	tree_nodes = nodes;
+	tree_size = (int)numNodes;
+	resetEncoding();
+	return true;
+}
+
+// 转成 C++ 字符串字面量，非 ASCII 字节用八进制转义，生成的文件与源码编码无关
+static string cppLiteral(const string& s) {
+	string out = "\"";
+	for (unsigned char c : s) {
+		if (c == '\\' || c == '"' || c == '?') {
+			out += '\\';
+			out += (char)c;
+		}
+		else if (c < 0x20 || c >= 0x7F) {
+			char buf[8];
+			snprintf(buf, sizeof(buf), "\\%03o", c);
+			out += buf;
+		}
+		else {
+			out += (char)c;
+		}
+	}
+	out += '"';
+	return out;
+}
+
+// 导出 C++ 预测函数：编译后的树逐节点展开成嵌套的 switch，常量都内联在代码里，不需要任何字典查找
+void ID3::exportCpp(ostream& out, const string& functionName) const {
+	const ValueDictionary& labels = dictionary(target_index);
+
+	out << "// Generated by ID3::exportCpp. Do not edit.\n";
+	out << "// codes[j] is the code of attribute j in the model encoding (see ID3::encodeBatch / ID3::encodeValue).\n";
+	out << "// Returns the label code, an index into " << functionName << "_labels, or -1 for a value unseen in training.\n";
+	for (size_t j = 0; j < attr_name.size(); ++j)
+		out << "//   codes[" << j << "]: " << cppLiteral(attr_name[j]) << "\n";
+	out << "#pragma once\n\n";
+
+	out << "static const int " << functionName << "_num_labels = " << labels.size() << ";\n";
+	out << "static const char* const " << functionName << "_labels[] = {\n";
+	for (int code = 0; code < labels.size(); ++code)
+		out << "\t" << cppLiteral(labels.value(code)) << ",\n";
+	out << "};\n\n";
+
+	// 数值属性：编码 -> 数值（包括阈值区间的代表值），分裂处与阈值比较
+	for (size_t j = 0; j < attr_name.size(); ++j) {
+		if (!numeric_attr[j])
+			continue;
+		out << "static const double " << functionName << "_values_" << j << "[] = { // " << cppLiteral(attr_name[j]) << "\n";
+		for (double v : numeric_values[j])
+			out << "\t" << numberText(v) << ",\n";
+		out << "};\n\n";
+	}
+
+	out << "inline int " << functionName << "(const int* codes) {\n";
+	if (tree_size == 0) {
+		out << "\t(void)codes;\n\treturn -1;\n";
+	}
+	else {
+		if (tree_nodes[0].attr < 0)
+			out << "\t(void)codes;\n";
+		exportNode(out, functionName, 0, 1);
+	}
+	out << "}\n";
+}
+
+bool ID3::exportCpp(const string& filename, const string& functionName) const {
+	ofstream out(filename, ios::binary);
+	if (!out) {
+		cerr << "错误: 无法写入文件 " << filename << endl;
+		return false;
+	}
+	exportCpp(out, functionName);
+	return (bool)out;
+}
+
+// 叶子生成 return；内部节点生成 switch，连续几个取值落到同一类别的叶子时合并成一组 case
+// 数值属性的节点生成 if / else，查出编码对应的数再与阈值比较
+void ID3::exportNode(ostream& out, const string& functionName, int index, int depth) const {
+	const string indent(depth, '\t');
+	const FlatNode& node = tree_nodes[index];
+	if (node.attr < 0) {
+		out << indent << "return " << node.next << ";\n";
+		return;
+	}
+
+	if (numeric_attr[node.attr]) {
+		const string code = "codes[" + to_string(node.attr) + "]";
+		out << indent << "if ((unsigned)" << code << " >= " << code_limit[node.attr] << "u) // " << cppLiteral(attr_name[node.attr]) << "\n";
+		out << indent << "\treturn -1;\n";
+		out << indent << "if (" << functionName << "_values_" << node.attr << "[" << code << "] <= " << numberText(node.threshold) << ") {\n";
+		exportNode(out, functionName, node.next, depth + 1);
+		out << indent << "}\n";
+		out << indent << "else {\n";
+		exportNode(out, functionName, node.next + 1, depth + 1);
+		out << indent << "}\n";
+		return;
+	}
+
+	const ValueDictionary& values = dictionary(node.attr);
+	out << indent << "switch (codes[" << node.attr << "]) { // " << cppLiteral(attr_name[node.attr]) << "\n";
+	for (int code = 0; code < values.size(); ) {
+		const FlatNode& child = tree_nodes[node.next + code];
+		int last = code;
+		if (child.attr < 0) {
+			while (last + 1 < values.size() && tree_nodes[node.next + last + 1].attr < 0 &&
+				tree_nodes[node.next + last + 1].next == child.next)
+				last++;
+		}
+		for (int c = code; c <= last; ++c)
+			out << indent << "case " << c << ": // " << cppLiteral(values.value(c)) << "\n";
+		exportNode(out, functionName, node.next + code, depth + 1);
+		code = last + 1;
+	}
+	out << indent << "default:\n";
+	out << indent << "\treturn -1;\n";
+	out << indent << "}\n";
 }
\ No newline at end of file
@@ -1,4 +1,4 @@
-/* 2452214   */
+/* 2452214 霍宇哲 大数据 */
 #pragma once
 #include <iostream>
 #include <vector>
@@ -7,54 +7,421 @@
 #include <cmath>
 //#include <algorithm>
 #include <set>
+#include <memory>
+#include "Dataset.h"
+#include "ThreadPool.h"
+#include "MappedFile.h"
+#include "Arena.h"
+#include "Profiler.h"
 
 using namespace std;
 
 const double EPSILON = 1e-4;
+const long long PARALLEL_MIN_WORK = 1 << 16; // 节点的 行数 x 候选属性数 达到该值才并行评估属性
+const int TASK_MIN_ROWS = 1 << 12;           // 子树的行数达到该值才作为并行任务构建，否则串行递归
+const int BATCH_TILE = 256;                  // 批量预测时一起逐层推进的行数
+const unsigned int MODEL_FILE_VERSION = 2;   // 模型文件格式版本
+const int OUT_OF_CORE_CHUNK_ROWS = 1 << 16;  // 外存训练每次从文件读入的行数
+const double PESSIMISTIC_LEAF_PENALTY = 0.5;  // 悲观剪枝给每个叶子的错误数加上的连续性修正
+const size_t OUT_OF_CORE_TABLE_BYTES = (size_t)256 << 20; // 外存训练一遍扫描中所有计数表的内存上限，超过时同一层分几遍扫描
+const size_t TREE_COMPACT_MIN_BYTES = (size_t)1 << 20;    // 增量更新后 Arena 里不再使用的字节超过它、且超过存活字节时整理一次
 
+class DatasetCacheReader;
+
+// 根节点在全部行上的计数，多个目标共享一遍扫描时预先统计好（见 MultiTargetModel）
+struct RootCounts {
+	vector<int> classCounts;       // 各类别的行数
+	vector<vector<int>> tables;    // tables[j] 是第 j 列的 取值 x 类别 计数表，布局同 calculateGain（目标列为空）
+};
+
+// 后剪枝前后的模型规模
+struct PruneStats {
+	int subtreesPruned;      // 换成叶子的子树数
+	int nodesBefore;
+	int nodesAfter;
+	int depthBefore;
+	int depthAfter;
+	size_t bytesBefore;      // 推理节点数组的字节数（modelBytes）
+	size_t bytesAfter;
+	double pathBefore;       // 剪枝所用数据上每行预测经过的平均节点数
+	double pathAfter;
+
+	PruneStats() : subtreesPruned(0), nodesBefore(0), nodesAfter(0), depthBefore(0), depthAfter(0),
+		bytesBefore(0), bytesAfter(0), pathBefore(0), pathAfter(0) {}
+};
+
+// 训练时的树节点，连同子节点数组一起分配在 ID3 的 Arena 里，整棵树一次释放
 struct TreeNode {
-	string Attribute;                // Ե
-	map<string, TreeNode*> children; // ֵ֧ -> ӽڵ
-	string label;                    // Ҷӽڵ㣬
+	int attr;             // 分裂属性的列索引
+	TreeNode** children;  // 分支：children[v] 是取值编码为 v 的子节点，个数等于该属性的取值数；数值属性只有 <= 阈值和 > 阈值两个子节点
+	double threshold;     // 数值属性的分裂阈值
+	int label;            // 如果是叶子节点，这里存类别编码（空数据集的叶子为 -1）
 	bool isLeaf;
+	bool dirty;           // 增量更新时本轮有新行经过
+	int* counts;          // 增量模式和外存训练时的计数：前面是各类别的行数，内部节点后面还有每个属性的 取值 x 类别 计数表
 
-	TreeNode() : isLeaf(false) {}
+	TreeNode() : attr(-1), children(nullptr), threshold(0), label(-1), isLeaf(false), dirty(false), counts(nullptr) {}
+};
+
+// 编译后的推理节点，整棵树存放在一个连续数组里
+// 内部节点：attr 是分裂属性的列索引，next 是第一个子节点的下标，取值编码为 v 的子节点位于 next + v
+// 数值属性的内部节点：取值 <= threshold 的子节点位于 next，其余位于 next + 1
+// 叶子节点：attr == -1，next 是类别编码
+struct FlatNode {
+	int attr;
+	int next;
+	double threshold;
+
+	FlatNode() : attr(-1), next(-1), threshold(0) {}
 };
 
 class ID3 {
 public:
 	ID3();
-	~ID3(); //̬ڴͷ
+	~ID3(); //动态内存释放
 
-	// ӿڣݹ
-	// ע⣺ data ÿһ˳ attributeNames Ӧtarget Ŀе
+	// 对外接口：传入数据构建树
+	// 注意：假设 data 的每一行顺序与 attributeNames 对应，target 是目标列的名称
 	void train(const vector<vector<string>>& data, const vector<string>& attributeNames, const string& target);
 
-	// ӿڣԤ
+	// 对外接口：在列式编码数据集上构建树，训练全程只比较整数编码
+	void train(const Dataset& data, const string& target);
+
+	// 带行权重训练：weights[r] 是第 r 行出现的次数（0 表示不参与），例如 bootstrap 抽样的结果
+	// 只是让行号重复出现，不复制数据，多棵树可以共享同一个 data；不能与增量模式同时使用
+	// 预测结果与 trainOnRows 相同，等同于在抽出的行上训练
+	void train(const Dataset& data, const string& target, const vector<int>& weights);
+
+	// 根节点直接使用预先统计好的 rootCounts（必须是 data 全部行对 target 的计数），不再扫描各列，其余与 train(data, target) 相同
+	void train(const Dataset& data, const string& target, const RootCounts& rootCounts);
+
+	// 只用 rowIds 列出的行训练（可以重复），数据不复制，字典仍是 data 的完整字典
+	// 分类属性上只在其余行里出现的取值，分支是不给类别的叶子（预测为 -1），所以 data 的字典排好序时，预测结果与在
+	// data.select(rowIds) 上训练的模型相同：那里这些取值不在字典里，同样无法预测（数值属性仍按 data 的整列字典判断）
+	// 交叉验证的每一折就是这样一个行号列表，多个折可以同时在同一个 data 上训练；不能与增量模式同时使用
+	void trainOnRows(const Dataset& data, const string& target, const vector<int>& rowIds);
+
+	// 每次分裂只在随机抽取的 count 个候选属性中选择（随机森林），count 为 0 表示使用全部候选属性
+	// 每个节点的抽样只取决于 seed 和节点的位置，所以与线程数无关；只作用于 train，增量更新和外存训练不支持
+	void setFeatureSubset(int count, unsigned int seed);
+
+	// 把这些列当作数值属性：不再每个取值一个分支，而是按 <= 阈值二分，同一列可以在一条路径上多次使用
+	// 阈值取相邻两个取值的中点，由按数值顺序扫一遍 取值 x 类别 计数表选出，增量更新和外存训练同样适用
+	// 只对全部取值都能解析成数字的列生效，其余的仍按分类属性处理；在训练之前设置
+	void setNumericAttributes(const vector<string>& names) { numeric_names = names; }
+
+	// 设置训练使用的线程数（默认 1，即串行；0 表示使用全部硬件线程）
+	// 多线程时同时并行评估候选属性和构建子树，得到的树与串行构建完全相同
+	void setThreadCount(int threads);
+	int getThreadCount() const { return thread_count; }
+
+	// 最近一次训练的各阶段耗时和计数（需要用 ID3_PROFILE 编译，否则 enabled 为 false、其余为 0）
+	const TrainStats& trainStats() const { return train_stats; }
+
+	// 是否同时记录每个区间的 trace 事件，训练后用 writeTrainTrace 写成 Chrome trace
+	void setTraceEvents(bool enabled) { trace_events = enabled; }
+	// 没有用 ID3_PROFILE 编译时没有可写的 trace，返回 false
+	bool writeTrainTrace(const string& filename) const;
+
+	// 对外接口：预测新数据（数值属性直接比较数值，训练时没见过的数也能预测）
 	string predict(const vector<string>& sample) const;
 
+	// 对外接口：预测已编码的样本（编码同 encodeBatch / encodeValue），返回类别编码，无法预测时返回 -1
+	int predictCode(const int* codes) const;
+
+	// 对外接口：批量预测，block 须使用模型的编码（见 encodeBatch），返回每行的类别编码，无法预测的行为 -1
+	vector<int> predictBatch(const Dataset& block) const;
+
+	// 预测 block 的第 row 行（block 须使用模型的编码），只读取路径上的列，用于按行号列表预测
+	int predictRow(const Dataset& block, int row) const;
+
+	// 只预测 block 的 [begin, end) 行，结果写到 out[0, end - begin)，便于多个线程分段预测同一个 block
+	void predictBatch(const Dataset& block, int begin, int end, int* out) const;
+
+	// 批量预测行优先存放的编码：codes[r * 属性数 + j] 是第 r 行第 j 列的编码（与 predictCode 的输入相同），结果写到 out[0, numRows)
+	// 预测服务把一批请求的编码直接拼在一起交给它，不需要先转成列式的 Dataset
+	void predictBatch(const int* codes, int numRows, int* out) const;
+
+	// 把任意编码的数据集按列名换成模型训练时的编码
+	// 数值属性上训练时没见过的数编码为它所在的阈值区间（见 setEncodingThresholds），结果的字典在原字典后面接上各区间，
+	// 所以批量预测与按数值比较的 predict 结果相同；其余没见过的取值编码为 -1
+	Dataset encodeBatch(const Dataset& data) const;
+
+	// 把第 col 列的一个取值换成模型的编码，规则与 encodeBatch 相同，无法编码时返回 -1
+	int encodeValue(int col, const string& value) const;
+
+	// 把树上各数值属性用到的分裂阈值追加到 thresholds[j]（列数不够时先扩充）
+	void collectThresholds(vector<vector<double>>& thresholds) const;
+
+	// 指定给没见过的数分配编码用的阈值：第 j 列的 m 个阈值排序去重后把数轴分成 m + 1 个区间，
+	// 落在第 k 个区间 (t[k - 1], t[k]] 的数编码为 字典大小 + k，同一区间里的数与每个阈值比较的结果都相同
+	// 训练、加载和剪枝之后自动设为本模型用到的阈值；几个模型共用一份编码时（随机森林、多目标的各棵树），
+	// 设为它们阈值的并集，每个模型的预测仍然精确
+	void setEncodingThresholds(const vector<vector<double>>& thresholds);
+
+	// 保存训练好的模型（编译后的树、属性名、各列字典），失败返回 false
+	// 文件格式：
+	//   文件头  "MID3" | 版本 u32 | 属性数 u32 | 目标列 u32 | 节点数 u32 | 保留 u32 | 字典区偏移 u64
+	//   节点区  紧跟文件头（8 字节对齐），节点数 x FlatNode { attr i32 | next i32 | threshold f64 }
+	//   字典区  每列：列名 (u32 长度 + 字节) | 是否数值属性 u32 | 取值数 u32 | 每个取值 (u32 长度 + 字节)，按编码顺序
+	bool save(const string& filename) const;
+
+	// 加载模型：映射文件，节点数组直接在映射的内存上使用，不重建 TreeNode，只还原字典
+	// 失败（文件不存在、格式或版本不符、内容损坏）返回 false，原有模型保持不变
+	bool load(const string& filename);
+
+	// 把模型导出成独立的 C++ 源文件：一个按整数编码逐层 switch 的函数 int functionName(const int* codes)，
+	// 输入输出与 predictCode 相同（编码使用模型的字典，返回类别编码，无法预测返回 -1），
+	// 另外生成 functionName_labels 数组用于把类别编码还原成字符串
+	void exportCpp(ostream& out, const string& functionName) const;
+	bool exportCpp(const string& filename, const string& functionName) const;
+
+	// 模型的列名（predictCode 等输入的列顺序）
+	const vector<string>& attributeNames() const { return attr_name; }
+
+	// 训练时各列的取值字典，用于把样本编码成 predictCode 需要的形式（数值属性上没见过的数用 encodeValue 编码）
+	const ValueDictionary& dictionary(int col) const { return (*attr_dicts)[col]; }
+	bool isNumeric(int col) const { return numeric_attr[col] != 0; }
+	const ValueDictionary& labelDictionary() const { return (*attr_dicts)[target_index]; }
+
+	// 下一次训练直接使用 dicts 作为模型的字典，不再从数据集复制一份；dicts 必须与训练数据的各列字典相同
+	// 在同一个数据集上训练的多个模型（随机森林、多目标的各棵树）由此共享一份字典，内存不随树的棵数增长
+	void shareDictionaries(const shared_ptr<const vector<ValueDictionary>>& dicts) { shared_dicts = dicts; }
+
+	// 增量训练：打开后 train 会保存一份训练数据并在每个节点上维护计数，之后可以用 update 吸收新数据
+	// 内部节点为每个属性保存一张 取值 x 类别 的计数表，内存约为 内部节点数 x 各属性取值数之和 x 类别数 x 4 字节
+	void setIncremental(bool enabled) { incremental = enabled; }
+	bool isIncremental() const { return incremental; }
+
+	// 吸收新的带标签的行（按列名对齐，编码任意）：沿各行的路径更新计数，只重建最佳属性发生变化的子树，
+	// 得到的树与在 trainingData() 上重新训练完全相同
+	// 出现训练时没见过的取值时字典会扩充、分支数随之改变，这时在全部数据上重新训练
+	// 模型不是增量训练的，或者新数据缺少某一列时返回 false
+	bool update(const Dataset& rows);
+
+	// 增量模式下累积的全部训练数据（训练数据 + 之后吸收的所有行），使用模型的编码
+	const Dataset& trainingData() const { return history; }
+
+	// 外存训练：数据留在磁盘上的缓存文件里（格式见 DatasetCache.h，可以用 DatasetCacheWriter 边生成边写），
+	// 按层构建，每层顺序扫描一遍文件，同时为这一层所有待分裂的节点统计 取值 x 类别 计数表；
+	// 内存里只有树、当前一层的计数表和一个行块，所以数据集可以比内存大得多
+	// 得到的树与把缓存读进内存后用 train 训练的完全相同；不支持增量模式；失败返回 false
+	bool trainOutOfCore(const string& cacheFile, const string& target);
+
+	// 编译后的树的节点数（0 表示没有模型）
+	int nodeCount() const { return tree_size; }
+
+	// 编译后的树的深度（只有根时为 0，没有模型时为 -1）
+	int treeDepth() const;
+
+	// 推理节点数组占用的字节数（节点数 x sizeof(FlatNode)），训练得到的和 load 得到的模型、剪枝前后都按同样的口径计算
+	size_t modelBytes() const;
+
+	// 后剪枝：把子树换成叶子，叶子的类别是 training 中到达该节点的行的多数类
+	// 在编译后的推理树上进行，所以训练得到的和 load 得到的模型都可以剪枝；剪完按层序重新紧凑排列，
+	// 训练时的 TreeNode 树随之释放，因此增量模式下不能剪枝
+	// training 和 validation 的编码任意（按列名对齐，同 encodeBatch），都必须有目标列；stats 非空时写入剪枝前后的规模
+
+	// 减少错误剪枝：自底向上，子树换成叶子后在 validation 上的错误不多于原来时就剪掉
+	// 没有验证行经过的子树也会被剪掉，所以 validation 要有足够多的行
+	bool pruneReducedError(const Dataset& training, const Dataset& validation, PruneStats* stats = nullptr);
+
+	// 悲观剪枝（Quinlan）：只用训练数据，每个叶子的错误数加 PESSIMISTIC_LEAF_PENALTY，
+	// 自顶向下，节点换成叶子后的修正错误不超过子树的修正错误加一个标准差时剪掉
+	// 训练时没有行的分支也是叶子，同样计入修正，所以分支很多而行很少的子树容易被剪掉
+	bool prunePessimistic(const Dataset& training, PruneStats* stats = nullptr);
+
 private:
 	TreeNode* root;
-	vector<string> attr_name;                // б
-	map<string, vector<string>> attr_values; // ¼ÿпܵȡֵ֧
-	map<string, int> attr_index_map;         //  -> 
-	int target_index;                        // Ŀе
+	Arena tree_arena;                        // root 整棵树的节点都分配在这里
+	vector<string> attr_name;                // 属性名列表
+	shared_ptr<const vector<ValueDictionary>> attr_dicts; // 记录每个属性所有可能的取值（用于生成完整分支和预测时编码），可以与其它模型共享
+	shared_ptr<const vector<ValueDictionary>> shared_dicts; // shareDictionaries 给出、下一次训练使用的字典
+	map<string, int> attr_index_map;         // 属性名 -> 列索引
+	int target_index;                        // 目标列的索引
+	const Dataset* dataset;                  // 训练期间使用的编码数据集（只在 train 内有效）
+	const RootCounts* root_counts;           // 训练期间根节点可用的预先统计（没有时为空）
+	vector<int> row_index;                   // 训练期间全树共享的行号数组，各节点原地划分自己的一段
+	vector<vector<char>> value_seen;         // 在行号列表上训练期间，各分类列的每个取值是否在训练行里出现过（否则为空）
+	int thread_count;                        // 训练线程数
+	unique_ptr<ThreadPool> pool;             // 训练期间的工作窃取线程池（串行时为空）
+
+#ifdef ID3_PROFILE
+	mutable Profiler profiler;               // 训练插桩的计数器（const 的评估函数里也要记录）
+#endif
+	TrainStats train_stats;                  // 最近一次训练的统计
+	bool trace_events;                       // 训练时是否记录 trace 事件
+	int feature_subset;                      // 每次分裂抽取的候选属性数，0 表示全部
+	unsigned int feature_seed;               // 抽取候选属性的种子
+	vector<string> numeric_names;            // setNumericAttributes 指定的列名
+	vector<char> numeric_attr;               // 第 j 列是否按数值属性分裂
+	vector<vector<double>> numeric_values;   // 数值属性各编码对应的数（分类属性为空），字典之后是各阈值区间的代表值
+	vector<vector<double>> numeric_cells;    // 给没见过的数分配编码用的阈值（排好序，分类属性为空），见 setEncodingThresholds
+	vector<int> code_limit;                  // 预测时第 j 列的有效编码数：字典的取值数，数值属性再加上阈值区间数
+	vector<vector<int>> numeric_order;       // 数值属性的编码按数值从小到大排列
+
+	bool incremental;                        // 是否增量训练
+	Dataset history;                         // 增量模式下累积的训练数据
+	vector<size_t> stats_offset;             // 内部节点的 counts 中第 j 列计数表的起点
+	size_t stats_size;                       // 内部节点的 counts 长度
+
+	// 增量更新时需要从数据重建的子树
+	struct PendingRebuild {
+		TreeNode* node;
+		int depth;
+		vector<bool> usedAttributes;
+		vector<int> rows;
+	};
+
+	// 外存训练中等待统计计数的节点
+	struct FrontierNode {
+		TreeNode* node;
+		int depth;
+		vector<bool> usedAttributes;
+	};
+
+	vector<FlatNode> flat_nodes;             // 编译后的推理树（层序排列）
+	unique_ptr<MappedFile> model_file;       // load 得到的模型文件映射
+	const FlatNode* tree_nodes;              // 推理用的节点数组：指向 flat_nodes 或者模型文件中的节点区，predict 只访问它
+	int tree_size;                           // 节点数，0 表示没有模型
+
+	// 释放树的内存（整个 Arena 一次归还）
+	void destroyTree();
+
+	// 在 Arena 上创建叶子节点
+	TreeNode* makeLeaf(int label);
+
+	// 当前线程在 tree_arena 里使用的通道：构建子树的任务各在自己的线程池线程上分配
+	int arenaLane() const { return pool ? pool->currentQueue() : 0; }
+
+	// 清空原有模型，按 attributeNames 建立列映射并找到目标列，目标列不存在时返回 false
+	bool resetModel(const vector<string>& attributeNames, const string& target);
+
+	// attr_dicts 就绪后确定数值属性（names 中全部取值都是数字的列），建立各编码的数值和排序
+	// 目标列也按同样的规则判断（它不参与分裂），这样同一数据上不同目标的模型对各列的编码相同
+	void setupNumeric(const vector<string>& names);
+
+	// 按本模型用到的阈值重建区间编码（训练、加载、剪枝之后）
+	void resetEncoding();
+
+	// 第 col 列第 k 个阈值区间在 encodeBatch 结果的字典里的名字，例如 "(2.5, 3]"
+	string cellName(int col, int k) const;
+
+	// 取值编码为 code 的行走 attr 上分裂的第几个分支：分类属性就是编码本身，数值属性 <= 阈值为 0，否则为 1
+	int branchOf(int attr, double threshold, int code) const {
+		return numeric_attr[attr] ? (numeric_values[attr][code] > threshold ? 1 : 0) : code;
+	}
+
+	// 在 attr 上分裂得到的子节点数
+	int branchCount(int attr) const { return numeric_attr[attr] ? 2 : dictionary(attr).size(); }
+
+	// dicts 的列数和各列取值数与 data 的字典一致时返回 true
+	static bool sameDictionaries(const vector<ValueDictionary>& dicts, const Dataset& data);
+
+	// train 的主体，由 train 包上整体计时并在结束后取出统计；rowIds 非空时只用这些行（可以重复）
+	void trainTree(const Dataset& data, const string& target, const vector<int>* rowIds = nullptr);
+
+	// 核心递归函数：当前节点拥有 row_index[begin, end) 这一段行号，depth 是节点的深度（根为 0）
+	TreeNode* buildTree(int begin, int end, int depth, vector<bool>& usedAttributes);
+
+	// 计算信息熵：counts 是各类别的样本数，total 是它们的总和
+	double calculateEntropy(const int* counts, int numClasses, int total) const;
+
+	// 计算单个属性的信息增益，countTable 是调用方提供的计数表缓冲区；数值属性同时返回最佳阈值
+	double calculateGain(int begin, int end, int attr, double baseEntropy, vector<int>& countTable, double& threshold) const;
+
+	// 从 取值 x 类别 的计数表求信息增益
+	double gainFromCounts(const int* countTable, int numValues, int numClasses, int total, double baseEntropy) const;
+
+	// 数值属性：按数值顺序扫一遍计数表，在每两个相邻的、当前节点里出现过的取值之间试切一刀，
+	// 返回最大的二分增益和对应的阈值（相邻两数的中点）；找不到切分点时返回 0
+	double numericGainFromCounts(const int* countTable, int attr, int numClasses, int total, double baseEntropy, double& threshold) const;
+
+	// 按属性类型选用 gainFromCounts 或 numericGainFromCounts
+	double splitGain(const int* countTable, int attr, int numClasses, int total, double baseEntropy, double& threshold) const;
+
+	// 计算各候选属性的信息增益（可并行），返回最佳属性的索引，如果没有正增益返回 -1；数值属性的阈值写到 threshold
+	// 设置了 feature_subset 时先按 depth 和 begin（确定了节点的位置）抽取候选属性
+	int getBestAttribute(int begin, int end, int depth, const vector<bool>& usedAttributes, double& threshold) const;
+
+	// 按增益选出最佳属性（严格大于，增益相同时保留下标较小的属性），增益不足 EPSILON 时返回 -1
+	int chooseAttribute(const vector<int>& candidates, const vector<double>& gains) const;
+
+	// 分割数据：把 row_index[begin, end) 按第 axis 列的分支原地划分，返回各分支段的边界（长度为分支数 + 1）
+	vector<int> splitData(int begin, int end, int axis, double threshold);
+
+	// 辅助：获取数据集中出现最多的类别编码（用于处理无法继续分裂的情况）
+	int getMajorityLabel(int begin, int end) const;
+
+	// 训练结束后把 TreeNode 树编译成 flat_nodes
+	void compileTree();
+
+	// 增量模式：为整棵树分配计数，并累加 history 的全部行
+	void initStats();
+
+	// 按 attr_dicts 计算 stats_offset 和 stats_size
+	void computeStatsLayout();
+
+	// 为 node 的子树分配（清零的）计数
+	void allocateStats(TreeNode* node);
+
+	// 把 history 的第 row 行沿 node 开始的路径累加到各节点的计数上
+	void accumulateRow(TreeNode* node, int row, bool markDirty);
+
+	// 把 node 就地改成叶子
+	void setLeaf(TreeNode* node, int label);
+
+	// 按类别计数做 buildTree 的前三项检查（空、纯净、属性用完），满足时把 node 改成叶子并返回 true
+	// total 和 majorityLabel 返回行数和多数类
+	bool settleLeaf(TreeNode* node, const int* classCounts, int parentMajority, const vector<bool>& usedAttributes, int& total, int& majorityLabel);
+
+	// 按更新后的计数重新判断 dirty 节点：能直接确定的就地修改，最佳属性变了的加入 rebuilds
+	void refreshNode(TreeNode* node, int parentMajority, int depth, vector<bool>& usedAttributes, vector<PendingRebuild>& rebuilds);
+
+	// 收集每个待重建节点下的行，用 buildTree 重建这些子树
+	void rebuildSubtrees(vector<PendingRebuild>& rebuilds);
+
+	// node 的子树现在用到的字节数（节点、子节点数组、计数）
+	size_t liveTreeBytes(const TreeNode* node) const;
+
+	// 把 node 的子树连同计数复制到 arena 里，返回新的子树根
+	TreeNode* copyTree(const TreeNode* node, Arena& arena) const;
+
+	// 被替换的子树和改成叶子的节点留下的内存累积到阈值后，把整棵树复制到新的 Arena 再换回 tree_arena
+	void compactTree();
+
+	// 从计数表（类别计数 + 各列的 取值 x 类别 表，布局见 stats_offset）选出最佳属性，没有正增益返回 -1
+	int bestAttributeFromStats(const int* counts, int total, const vector<bool>& usedAttributes, double& threshold) const;
+
+	// 外存训练的主体：逐层扫描 reader 直到没有待统计的节点
+	bool trainLevelWise(DatasetCacheReader& reader, const string& target);
+
+	// 扫描一遍文件，为 counts 非空的待统计节点累加计数，读取失败返回 false
+	bool scanLevel(DatasetCacheReader& reader);
+
+	// 按统计好的计数决定一个节点：成为叶子，或者分裂，并把还需要统计的子节点放入 next
+	void expandNode(FrontierNode& frontier, vector<FrontierNode>& next);
+
+	// 把 encoded（模型的编码）逐行沿推理树走下去：counts[节点 * 类别数 + 类别] 累加经过每个节点的行（类别未知的行不计），
+	// 因为没见过的取值停在某个节点的行再计入 stuck[节点]（可以为空）；返回所有行经过的节点总数
+	long long routeCounts(const Dataset& encoded, vector<int>& counts, vector<int>* stuck) const;
 
-	// ͷڴ
-	void destroyTree(TreeNode* node);
+	// 模型可以剪枝（已训练、不是增量模式）并且 data 有目标列，否则报错返回 false
+	bool canPrune(const Dataset& data) const;
 
-	// ĵݹ麯
-	TreeNode* buildTree(vector<vector<string>> currentData, vector<bool> usedAttributes);
+	// 各节点换成叶子时的类别：counts（routeCounts 的结果）中的多数类，没有行经过的节点取父节点的
+	vector<int> pruneLabels(const vector<int>& counts) const;
 
-	// Ϣ
-	double calculateEntropy(const vector<vector<string>>& data) const;
+	// 当前推理树的规模，平均路径长度在 reference（模型的编码）上统计
+	void measureTree(const Dataset& reference, int& nodes, int& depth, size_t& bytes, double& path) const;
 
-	// Ϣ棬Եû淵 -1
-	int getBestAttribute(const vector<vector<string>>& data, const vector<bool>& usedAttributes) const;
+	// 把 collapse 标记的内部节点换成类别为 labels 的叶子（已被剪掉的子树里的标记不起作用），
+	// 按层序重新排列推理树并释放训练树，返回换成叶子的子树数
+	int applyPrune(const vector<char>& collapse, const vector<int>& labels);
 
-	// ָݣص axis еֵ value ЩУɾУֻɸѡУ
-	vector<vector<string>> splitData(const vector<vector<string>>& data, int axis, const string& value) const;
+	// 第 index 个节点的分支数（叶子为 0）
+	int flatBranches(int index) const { return tree_nodes[index].attr < 0 ? 0 : branchCount(tree_nodes[index].attr); }
 
-	// ȡݼгڴ޷ѵ
-	string getMajorityLabel(const vector<vector<string>>& data) const;
+	// 生成以 tree_nodes[index] 为根的子树的代码
+	void exportNode(ostream& out, const string& functionName, int index, int depth) const;
 };
\ No newline at end of file
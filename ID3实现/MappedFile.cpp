@@ -0,0 +1,116 @@
+/* 2452214 霍宇哲 大数据 */
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile()
+	: base(nullptr), length(0), opened(false), fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr) {}
+
+bool MappedFile::open(const string& filename) {
+	close();
+
+	HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+		OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize)) {
+		CloseHandle(file);
+		return false;
+	}
+
+	fileHandle = file;
+	length = (size_t)fileSize.QuadPart;
+	opened = true;
+	if (length == 0)
+		return true; // 空文件不能建立映射
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mapping) {
+		close();
+		return false;
+	}
+	mappingHandle = mapping;
+
+	base = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!base) {
+		close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::close() {
+	if (base)
+		UnmapViewOfFile(base);
+	if (mappingHandle)
+		CloseHandle((HANDLE)mappingHandle);
+	if (fileHandle != INVALID_HANDLE_VALUE)
+		CloseHandle((HANDLE)fileHandle);
+	base = nullptr;
+	length = 0;
+	opened = false;
+	mappingHandle = nullptr;
+	fileHandle = INVALID_HANDLE_VALUE;
+}
+
+#else
+
+MappedFile::MappedFile() : base(nullptr), length(0), opened(false), fd(-1) {}
+
+bool MappedFile::open(const string& filename) {
+	close();
+
+	fd = ::open(filename.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0) {
+		close();
+		return false;
+	}
+
+	length = (size_t)st.st_size;
+	opened = true;
+	if (length == 0)
+		return true; // 空文件不能建立映射
+
+	void* p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (p == MAP_FAILED) {
+		close();
+		return false;
+	}
+	madvise(p, length, MADV_SEQUENTIAL);
+	base = (const char*)p;
+	return true;
+}
+
+void MappedFile::close() {
+	if (base)
+		munmap((void*)base, length);
+	if (fd >= 0)
+		::close(fd);
+	base = nullptr;
+	length = 0;
+	opened = false;
+	fd = -1;
+}
+
+#endif
+
+MappedFile::~MappedFile() {
+	close();
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+/* 2452214 霍宇哲 大数据 */
+#pragma once
+#include <string>
+#include <cstddef>
+
+using namespace std;
+
+// 只读内存映射文件：把整个文件映射进地址空间，按需由操作系统分页读入，不做任何拷贝
+class MappedFile {
+public:
+	MappedFile();
+	~MappedFile();
+
+	// 打开并映射文件，失败返回 false（空文件也算成功，size() 为 0）
+	bool open(const string& filename);
+	void close();
+
+	bool isOpen() const { return opened; }
+	const char* data() const { return base; }
+	size_t size() const { return length; }
+
+private:
+	const char* base;
+	size_t length;
+	bool opened;
+#ifdef _WIN32
+	void* fileHandle;
+	void* mappingHandle;
+#else
+	int fd;
+#endif
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+};
\ No newline at end of file
@@ -0,0 +1,159 @@
+/* 2452214 霍宇哲 大数据 */
+#include "MultiTarget.h"
+#include "ThreadPool.h"
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+#include <thread>
+
+using namespace std;
+
+MultiTargetModel::MultiTargetModel(const MultiTargetOptions& options)
+	: options(options), root_scan_seconds(0), tree_seconds(0) {
+	if (this->options.threads <= 0)
+		this->options.threads = max(1, (int)thread::hardware_concurrency());
+}
+
+// 按列并行的一遍扫描：第 j 列的每一行只读一次编码，再按各目标的类别分别累加到各自的计数表
+vector<RootCounts> MultiTargetModel::scanRoots(const Dataset& data, const vector<int>& targetIndices, int threads) {
+	const int numTargets = (int)targetIndices.size();
+	const int numAttrs = data.numAttributes();
+	const int n = data.numRows();
+
+	vector<const int*> labels(numTargets);
+	vector<int> numClasses(numTargets);
+	vector<RootCounts> result(numTargets);
+	for (int t = 0; t < numTargets; ++t) {
+		labels[t] = data.column(targetIndices[t]).data();
+		numClasses[t] = data.dictionary(targetIndices[t]).size();
+		result[t].classCounts.assign(numClasses[t], 0);
+		result[t].tables.resize(numAttrs);
+	}
+
+	// 任务 0 .. numAttrs - 1 统计各列，最后一个任务统计类别计数；各任务只写自己的那一格，互不冲突
+	auto scan = [&](int j) {
+		if (j == numAttrs) {
+			for (int t = 0; t < numTargets; ++t)
+				for (int r = 0; r < n; ++r)
+					result[t].classCounts[labels[t][r]]++;
+			return;
+		}
+
+		// 这一列作为特征的目标（目标列本身不统计）
+		vector<int*> tables;
+		vector<const int*> targetLabels;
+		vector<int> strides;
+		const int numValues = data.dictionary(j).size();
+		for (int t = 0; t < numTargets; ++t) {
+			if (targetIndices[t] == j)
+				continue;
+			result[t].tables[j].assign((size_t)numValues * numClasses[t], 0);
+			tables.push_back(result[t].tables[j].data());
+			targetLabels.push_back(labels[t]);
+			strides.push_back(numClasses[t]);
+		}
+
+		const int* column = data.column(j).data();
+		const int active = (int)tables.size();
+		for (int r = 0; r < n; ++r) {
+			const int v = column[r];
+			for (int k = 0; k < active; ++k)
+				tables[k][(size_t)v * strides[k] + targetLabels[k][r]]++;
+		}
+	};
+
+	if (threads > 1) {
+		ThreadPool pool(min(threads, numAttrs + 1));
+		pool.parallelFor(numAttrs + 1, scan);
+	}
+	else {
+		for (int j = 0; j <= numAttrs; ++j)
+			scan(j);
+	}
+	return result;
+}
+
+bool MultiTargetModel::train(const Dataset& data, const vector<string>& targets) {
+	trees.clear();
+	target_names.clear();
+	if (data.numRows() == 0 || targets.empty()) {
+		cerr << "错误: 数据集为空或没有指定目标" << endl;
+		return false;
+	}
+
+	vector<int> targetIndices;
+	for (const string& target : targets) {
+		int index = data.findAttribute(target);
+		if (index < 0) {
+			cerr << "错误: 数据集中没有目标列 " << target << endl;
+			return false;
+		}
+		if (find(targetIndices.begin(), targetIndices.end(), index) != targetIndices.end()) {
+			cerr << "错误: 目标列 " << target << " 重复" << endl;
+			return false;
+		}
+		targetIndices.push_back(index);
+	}
+
+	// 1. 一遍扫描统计所有目标的根节点计数
+	auto start = chrono::steady_clock::now();
+	vector<RootCounts> roots = scanRoots(data, targetIndices, options.threads);
+	root_scan_seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	// 2. 同时训练各目标：同时运行的树各占一个线程，多出的线程平均分给每棵树内部
+	start = chrono::steady_clock::now();
+	const int numTargets = (int)targets.size();
+	const int concurrent = min(options.threads, numTargets);
+	const int perTree = max(1, options.threads / numTargets);
+	vector<ValueDictionary> dicts;
+	for (int j = 0; j < data.numAttributes(); ++j)
+		dicts.push_back(data.dictionary(j));
+	const shared_ptr<const vector<ValueDictionary>> shared = make_shared<const vector<ValueDictionary>>(move(dicts)); // 各棵树共享一份字典
+	trees.resize(numTargets);
+	auto trainOne = [&](int t) {
+		unique_ptr<ID3> tree(new ID3());
+		tree->setThreadCount(perTree);
+		tree->setNumericAttributes(options.numericAttributes);
+		tree->shareDictionaries(shared);
+		tree->train(data, targets[t], roots[t]);
+		vector<vector<int>>().swap(roots[t].tables); // 根节点选完属性后计数表就没用了
+		trees[t] = move(tree);
+	};
+	if (concurrent > 1) {
+		ThreadPool pool(concurrent);
+		pool.parallelFor(numTargets, trainOne);
+	}
+	else {
+		for (int t = 0; t < numTargets; ++t)
+			trainOne(t);
+	}
+	tree_seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	// 各棵树的数值列相同（只取决于数据和列名），共用 trees[0] 的编码，没见过的数按所有树阈值的并集分区间
+	vector<vector<double>> thresholds;
+	for (const unique_ptr<ID3>& tree : trees)
+		tree->collectThresholds(thresholds);
+	for (const unique_ptr<ID3>& tree : trees)
+		tree->setEncodingThresholds(thresholds);
+
+	target_names = targets;
+	return true;
+}
+
+int MultiTargetModel::findTarget(const string& target) const {
+	for (int i = 0; i < (int)target_names.size(); ++i)
+		if (target_names[i] == target)
+			return i;
+	return -1;
+}
+
+Dataset MultiTargetModel::encodeBatch(const Dataset& data) const {
+	return trees.empty() ? Dataset() : trees[0]->encodeBatch(data);
+}
+
+vector<vector<int>> MultiTargetModel::predictBatch(const Dataset& block) const {
+	vector<vector<int>> result(trees.size());
+	for (int t = 0; t < (int)trees.size(); ++t)
+		result[t] = trees[t]->predictBatch(block);
+	return result;
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+/* 2452214 霍宇哲 大数据 */
+#pragma once
+#include <vector>
+#include <string>
+#include <memory>
+#include "Dataset.h"
+#include "ID3.h"
+
+using namespace std;
+
+// 多目标训练的参数
+struct MultiTargetOptions {
+	int threads;                      // 总线程数（0 表示使用全部硬件线程）：目标数少于线程数时，多出的线程分给各棵树内部并行，不影响结果
+	vector<string> numericAttributes; // 按数值阈值二分的列（见 ID3::setNumericAttributes）
+
+	MultiTargetOptions() : threads(1) {}
+};
+
+// 多目标训练：在同一个编码数据集上为多个目标列各训练一棵 ID3 树
+// 所有树共享调用方的编码列和一份列字典，不复制数据；根节点需要的 取值 x 类别 计数表由一遍扫描同时为所有目标统计
+// （每列只读一次，而不是每个目标各读一次），之后各棵树同时训练，每棵树与单独用 ID3::train 训练的完全相同
+// 每棵树把其余的列（包括其它目标列）都当作候选属性，与单独训练一致
+class MultiTargetModel {
+public:
+	explicit MultiTargetModel(const MultiTargetOptions& options = MultiTargetOptions());
+
+	// 训练 targets 中的每个目标；有目标列不存在、目标重复或数据为空时返回 false
+	bool train(const Dataset& data, const vector<string>& targets);
+
+	int targetCount() const { return (int)trees.size(); }
+	const string& targetName(int i) const { return target_names[i]; }
+	const ID3& tree(int i) const { return *trees[i]; }
+
+	// 目标名 -> 下标，找不到返回 -1
+	int findTarget(const string& target) const;
+
+	// 把任意编码的数据集换成模型的编码（各棵树使用同一份训练数据的字典，没见过的数按所有树的阈值分区间）
+	Dataset encodeBatch(const Dataset& data) const;
+
+	// 批量预测全部目标：block 须使用模型的编码，result[i] 是第 i 个目标每行的类别编码（无法预测为 -1）
+	vector<vector<int>> predictBatch(const Dataset& block) const;
+
+	// 上一次训练中共享的根节点扫描和训练各棵树的耗时（秒）
+	double rootScanSeconds() const { return root_scan_seconds; }
+	double treeSeconds() const { return tree_seconds; }
+
+	// 一遍扫描 data 的各列，同时为 targetIndices 中的每个目标统计根节点的计数，result[t] 对应 targetIndices[t]
+	// 按列并行，每列只读一次
+	static vector<RootCounts> scanRoots(const Dataset& data, const vector<int>& targetIndices, int threads);
+
+private:
+	MultiTargetOptions options;
+	vector<string> target_names;
+	vector<unique_ptr<ID3>> trees;
+	double root_scan_seconds;
+	double tree_seconds;
+};
\ No newline at end of file
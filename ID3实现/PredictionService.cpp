@@ -0,0 +1,392 @@
+/* 2452214 霍宇哲 大数据 */
+#include "PredictionService.h"
+#include <iostream>
+#include <sstream>
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+
+void LatencyRecorder::add(double seconds) {
+	lock_guard<mutex> guard(lock);
+	++seen;
+	if ((int)samples.size() < LATENCY_MAX_SAMPLES) {
+		samples.push_back(seconds);
+		return;
+	}
+	// 蓄水池抽样：第 seen 个样本以 容量 / seen 的概率替换一个旧样本
+	uint64_t slot = rng.next() % (uint64_t)seen;
+	if (slot < (uint64_t)LATENCY_MAX_SAMPLES)
+		samples[slot] = seconds;
+}
+
+LatencySummary LatencyRecorder::summary() const {
+	vector<double> sorted;
+	LatencySummary result;
+	{
+		lock_guard<mutex> guard(lock);
+		sorted = samples;
+		result.count = seen;
+	}
+	if (sorted.empty())
+		return result;
+
+	size_t n = sorted.size();
+	auto quantile = [&](double q) {
+		size_t k = min(n - 1, (size_t)(q * n));
+		nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+		return sorted[k];
+	};
+	result.max = *max_element(sorted.begin(), sorted.end());
+	result.p99 = quantile(0.99);
+	result.p50 = quantile(0.5);
+	return result;
+}
+
+void LatencyRecorder::reset() {
+	lock_guard<mutex> guard(lock);
+	samples.clear();
+	seen = 0;
+}
+
+PredictionServer::PredictionServer(const ID3& model, const ServerOptions& options)
+	: model(model), options(options), num_attrs((int)model.attributeNames().size()), stopping(false),
+	queued_rows(0), queue_closed(false), shutdown_requested(false), running(false),
+	total_requests(0), total_rows(0), total_batches(0) {
+	this->options.batchRows = max(1, options.batchRows);
+	this->options.maxDelayMicros = max(0, options.maxDelayMicros);
+}
+
+PredictionServer::~PredictionServer() {
+	stop();
+}
+
+bool PredictionServer::start() {
+	if (num_attrs == 0) {
+		cerr << "错误: 预测服务需要已训练的模型" << endl;
+		return false;
+	}
+	bool ok = options.unixPath.empty() ? listener.listenTcp(options.port) : listener.listenUnix(options.unixPath);
+	if (!ok) {
+		cerr << "错误: 无法在 " << (options.unixPath.empty() ? "端口 " + to_string(options.port) : options.unixPath) << " 上监听" << endl;
+		return false;
+	}
+
+	started = chrono::steady_clock::now();
+	running = true;
+	accept_thread = thread(&PredictionServer::acceptLoop, this);
+	batch_thread = thread(&PredictionServer::batchLoop, this);
+	return true;
+}
+
+void PredictionServer::wait() {
+	chrono::steady_clock::time_point last = chrono::steady_clock::now();
+	long long lastRequests = 0, lastRows = 0, lastBatches = 0;
+	auto done = [&] { return !running || shutdown_requested; };
+
+	unique_lock<mutex> guard(state_lock);
+	while (!done()) {
+		if (options.statsIntervalSeconds <= 0) {
+			state_changed.wait(guard, done);
+			break;
+		}
+		if (state_changed.wait_for(guard, chrono::seconds(options.statsIntervalSeconds), done))
+			break;
+		guard.unlock();
+		report(last, lastRequests, lastRows, lastBatches);
+		guard.lock();
+	}
+}
+
+void PredictionServer::stop() {
+	{
+		lock_guard<mutex> guard(state_lock);
+		if (!running)
+			return;
+		running = false;
+	}
+	state_changed.notify_all();
+
+	// 先停止接受新连接，再断开已有连接（读线程的 recv 随即返回），最后让批处理线程处理完队列后退出
+	stopping = true;
+	if (accept_thread.joinable())
+		accept_thread.join();
+	listener.close();
+
+	{
+		lock_guard<mutex> guard(readers_lock);
+		for (Reader& reader : readers)
+			reader.connection->socket.shutdownBoth();
+		for (Reader& reader : readers)
+			reader.worker.join();
+		readers.clear();
+	}
+
+	{
+		lock_guard<mutex> guard(queue_lock);
+		queue_closed = true;
+	}
+	queue_ready.notify_all();
+	if (batch_thread.joinable())
+		batch_thread.join();
+}
+
+void PredictionServer::acceptLoop() {
+	while (!stopping) {
+		Socket client;
+		if (!listener.accept(client, 100))
+			continue;
+
+		auto connection = make_shared<Connection>();
+		connection->socket = move(client);
+		auto finished = make_shared<atomic<bool>>(false);
+
+		lock_guard<mutex> guard(readers_lock);
+		// 回收已经断开的连接的读线程
+		size_t kept = 0;
+		for (size_t i = 0; i < readers.size(); ++i) {
+			if (*readers[i].finished)
+				readers[i].worker.join();
+			else if (kept++ != i)
+				readers[kept - 1] = move(readers[i]);
+		}
+		readers.resize(kept);
+
+		Reader reader;
+		reader.connection = connection;
+		reader.finished = finished;
+		reader.worker = thread([this, connection, finished] {
+			readLoop(connection);
+			*finished = true;
+		});
+		readers.push_back(move(reader));
+	}
+}
+
+void PredictionServer::readLoop(shared_ptr<Connection> connection) {
+	unsigned int header[4];
+	while (connection->socket.recvAll(header, sizeof(header))) {
+		unsigned int length = header[0], op = header[1], id = header[2], rows = header[3];
+
+		if (op == PREDICT_OP_PREDICT && rows <= (unsigned int)PREDICT_MAX_REQUEST_ROWS
+			&& (unsigned long long)length == 12 + (unsigned long long)rows * num_attrs * sizeof(int)) {
+			PendingRequest request;
+			request.connection = connection;
+			request.id = id;
+			request.rows = (int)rows;
+			request.codes.resize((size_t)rows * num_attrs);
+			if (rows > 0 && !connection->socket.recvAll(request.codes.data(), request.codes.size() * sizeof(int)))
+				break;
+			request.arrival = chrono::steady_clock::now();
+			{
+				lock_guard<mutex> guard(queue_lock);
+				queued_rows += request.rows;
+				queue.push_back(move(request));
+			}
+			queue_ready.notify_one();
+			continue;
+		}
+
+		if (op == PREDICT_OP_STATS && length == 12) {
+			string json = statsJson();
+			sendFrame(*connection, PREDICT_STATUS_OK, id, (unsigned int)json.size(), json.data(), json.size());
+			continue;
+		}
+
+		if (op == PREDICT_OP_SHUTDOWN && length == 12) {
+			sendFrame(*connection, PREDICT_STATUS_OK, id, 0, nullptr, 0);
+			{
+				lock_guard<mutex> guard(state_lock);
+				shutdown_requested = true;
+			}
+			state_changed.notify_all();
+			continue;
+		}
+
+		// 长度对不上时无法找到下一个请求的开头，只能断开
+		cerr << "预测服务: 无效的请求 (操作 " << op << ", 长度 " << length << ", 行数 " << rows << ")，断开连接" << endl;
+		sendFrame(*connection, PREDICT_STATUS_BAD_REQUEST, id, 0, nullptr, 0);
+		break;
+	}
+	connection->socket.shutdownBoth();
+}
+
+void PredictionServer::batchLoop() {
+	vector<PendingRequest> batch;
+	while (true) {
+		{
+			unique_lock<mutex> guard(queue_lock);
+			queue_ready.wait(guard, [&] { return queue_closed || !queue.empty(); });
+			if (queue.empty())
+				return;
+
+			// 攒够 batchRows 行，或者最早的请求已经等了 maxDelayMicros，就开始预测
+			auto deadline = queue.front().arrival + chrono::microseconds(options.maxDelayMicros);
+			while (!queue_closed && queued_rows < options.batchRows && chrono::steady_clock::now() < deadline)
+				queue_ready.wait_until(guard, deadline);
+
+			// 至少取一个请求（单个请求可能就超过 batchRows 行）
+			int rows = 0;
+			while (!queue.empty() && (batch.empty() || rows + queue.front().rows <= options.batchRows)) {
+				rows += queue.front().rows;
+				queued_rows -= queue.front().rows;
+				batch.push_back(move(queue.front()));
+				queue.pop_front();
+			}
+		}
+		runBatch(batch);
+		batch.clear();
+	}
+}
+
+void PredictionServer::runBatch(vector<PendingRequest>& batch) {
+	int rows = 0;
+	for (const PendingRequest& request : batch)
+		rows += request.rows;
+
+	// 只有一个请求时直接用它的编码，不再复制
+	const int* codes = batch[0].codes.data();
+	if (batch.size() > 1) {
+		batch_codes.resize((size_t)rows * num_attrs);
+		size_t offset = 0;
+		for (const PendingRequest& request : batch) {
+			copy(request.codes.begin(), request.codes.end(), batch_codes.begin() + offset);
+			offset += request.codes.size();
+		}
+		codes = batch_codes.data();
+	}
+	batch_labels.resize(rows);
+	model.predictBatch(codes, rows, batch_labels.data());
+
+	int offset = 0;
+	for (const PendingRequest& request : batch) {
+		sendFrame(*request.connection, PREDICT_STATUS_OK, request.id, (unsigned int)request.rows,
+			batch_labels.data() + offset, (size_t)request.rows * sizeof(int));
+		offset += request.rows;
+		double seconds = chrono::duration<double>(chrono::steady_clock::now() - request.arrival).count();
+		latency.add(seconds);
+		window_latency.add(seconds);
+	}
+	total_requests += (long long)batch.size();
+	total_rows += rows;
+	++total_batches;
+}
+
+bool PredictionServer::sendFrame(Connection& connection, unsigned int status, unsigned int id, unsigned int count, const void* payload, size_t bytes) {
+	// 头和内容拼在一起一次发出，避免小包
+	vector<char> frame(PREDICT_HEADER_BYTES + bytes);
+	unsigned int header[4] = { (unsigned int)(12 + bytes), status, id, count };
+	memcpy(frame.data(), header, sizeof(header));
+	if (bytes > 0)
+		memcpy(frame.data() + PREDICT_HEADER_BYTES, payload, bytes);
+
+	lock_guard<mutex> guard(connection.sendLock);
+	return connection.socket.sendAll(frame.data(), frame.size());
+}
+
+string PredictionServer::statsJson() const {
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+	long long requests = total_requests, rows = total_rows, batches = total_batches;
+	LatencySummary summary = latency.summary();
+
+	ostringstream out;
+	out << "{\"uptime_seconds\":" << seconds
+		<< ",\"requests\":" << requests
+		<< ",\"rows\":" << rows
+		<< ",\"batches\":" << batches
+		<< ",\"mean_batch_rows\":" << (batches > 0 ? (double)rows / batches : 0.0)
+		<< ",\"qps\":" << (seconds > 0 ? requests / seconds : 0.0)
+		<< ",\"p50_us\":" << summary.p50 * 1e6
+		<< ",\"p99_us\":" << summary.p99 * 1e6
+		<< ",\"max_us\":" << summary.max * 1e6 << "}";
+	return out.str();
+}
+
+void PredictionServer::report(chrono::steady_clock::time_point& last, long long& lastRequests, long long& lastRows, long long& lastBatches) {
+	auto now = chrono::steady_clock::now();
+	double seconds = max(chrono::duration<double>(now - last).count(), 1e-9);
+	long long requests = total_requests, rows = total_rows, batches = total_batches;
+	LatencySummary summary = window_latency.summary();
+	window_latency.reset();
+
+	if (requests > lastRequests) {
+		cerr << "[预测服务] " << (long long)((requests - lastRequests) / seconds) << " 请求/秒, "
+			<< (long long)((rows - lastRows) / seconds) << " 行/秒, 平均每批 "
+			<< (double)(rows - lastRows) / max(1LL, batches - lastBatches) << " 行, 延迟 p50 "
+			<< (long long)(summary.p50 * 1e6) << " us, p99 " << (long long)(summary.p99 * 1e6) << " us" << endl;
+	}
+	last = now;
+	lastRequests = requests;
+	lastRows = rows;
+	lastBatches = batches;
+}
+
+bool PredictionClient::sendRequest(unsigned int op, unsigned int id, unsigned int rows, const void* payload, size_t bytes) {
+	buffer.resize(PREDICT_HEADER_BYTES + bytes);
+	unsigned int header[4] = { (unsigned int)(12 + bytes), op, id, rows };
+	memcpy(buffer.data(), header, sizeof(header));
+	if (bytes > 0)
+		memcpy(buffer.data() + PREDICT_HEADER_BYTES, payload, bytes);
+	return socket.sendAll(buffer.data(), buffer.size());
+}
+
+bool PredictionClient::receiveFrame(unsigned int& status, unsigned int& id, unsigned int& count, vector<char>& payload) {
+	unsigned int header[4];
+	if (!socket.recvAll(header, sizeof(header)) || header[0] < 12)
+		return false;
+	status = header[1];
+	id = header[2];
+	count = header[3];
+	payload.resize(header[0] - 12);
+	return payload.empty() || socket.recvAll(payload.data(), payload.size());
+}
+
+unsigned int PredictionClient::sendPredict(const int* codes, int numRows, int numAttrs) {
+	if (numRows < 0 || numRows > PREDICT_MAX_REQUEST_ROWS) {
+		cerr << "错误: 单个请求最多 " << PREDICT_MAX_REQUEST_ROWS << " 行" << endl;
+		return 0;
+	}
+	unsigned int id = next_id++;
+	if (next_id == 0)
+		next_id = 1;
+	if (!sendRequest(PREDICT_OP_PREDICT, id, (unsigned int)numRows, codes, (size_t)numRows * numAttrs * sizeof(int)))
+		return 0;
+	return id;
+}
+
+bool PredictionClient::receivePredict(unsigned int& id, vector<int>& labels) {
+	unsigned int status, count;
+	vector<char> payload;
+	if (!receiveFrame(status, id, count, payload))
+		return false;
+	if (status != PREDICT_STATUS_OK || payload.size() != (size_t)count * sizeof(int)) {
+		cerr << "错误: 预测服务拒绝了请求 " << id << " (状态 " << status << ")" << endl;
+		return false;
+	}
+	labels.resize(count);
+	if (count > 0)
+		memcpy(labels.data(), payload.data(), payload.size());
+	return true;
+}
+
+bool PredictionClient::predict(const int* codes, int numRows, int numAttrs, vector<int>& labels) {
+	unsigned int id = sendPredict(codes, numRows, numAttrs);
+	unsigned int received;
+	return id != 0 && receivePredict(received, labels) && received == id;
+}
+
+bool PredictionClient::serverStats(string& json) {
+	unsigned int id = next_id++, status, received, count;
+	vector<char> payload;
+	if (!sendRequest(PREDICT_OP_STATS, id, 0, nullptr, 0) || !receiveFrame(status, received, count, payload))
+		return false;
+	json.assign(payload.begin(), payload.end());
+	return status == PREDICT_STATUS_OK && received == id;
+}
+
+bool PredictionClient::shutdownServer() {
+	unsigned int id = next_id++, status, received, count;
+	vector<char> payload;
+	return sendRequest(PREDICT_OP_SHUTDOWN, id, 0, nullptr, 0) && receiveFrame(status, received, count, payload)
+		&& status == PREDICT_STATUS_OK && received == id;
+}
\ No newline at end of file
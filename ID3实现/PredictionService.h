@@ -0,0 +1,196 @@
+/* 2452214 霍宇哲 大数据 */
+#pragma once
+#include <vector>
+#include <string>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include "ID3.h"
+#include "Socket.h"
+#include "Random.h"
+
+using namespace std;
+
+// 预测服务的二进制协议，数值按本机字节序（服务只在本机上使用）
+//   请求  长度 u32 | 操作 u32 | 请求号 u32 | 行数 u32 | 行数 x 属性数 个 i32 编码
+//   响应  长度 u32 | 状态 u32 | 请求号 u32 | 个数 u32 | 内容
+// 长度不含它自己的 4 字节。请求的编码按行存放，使用模型的编码（同 ID3::encodeBatch / predictCode，目标列的值不使用）；
+// PREDICT 响应的内容是每行一个 i32 类别编码（无法预测为 -1），STATS 响应的内容是 JSON 文本（个数为字节数）
+// 同一个连接上可以连续发出多个请求而不等响应（流水线），响应用请求号对应
+
+enum PredictOp {
+	PREDICT_OP_PREDICT = 1,   // 预测一组行
+	PREDICT_OP_STATS = 2,     // 取服务端的累计统计
+	PREDICT_OP_SHUTDOWN = 3   // 让服务退出
+};
+
+enum PredictStatus {
+	PREDICT_STATUS_OK = 0,
+	PREDICT_STATUS_BAD_REQUEST = 1   // 操作未知或者长度与行数、属性数不符，随后服务端关闭连接
+};
+
+const int PREDICT_HEADER_BYTES = 16;
+const int PREDICT_MAX_REQUEST_ROWS = 1 << 16;  // 单个请求的行数上限
+const int LATENCY_MAX_SAMPLES = 1 << 20;       // 延迟统计最多保留的样本数，超过后蓄水池抽样
+
+// 延迟的分位数（秒）
+struct LatencySummary {
+	long long count;
+	double p50;
+	double p99;
+	double max;
+
+	LatencySummary() : count(0), p50(0), p99(0), max(0) {}
+};
+
+// 记录每个请求的延迟，可以在多个线程里同时记录；样本超过上限后用蓄水池抽样，内存固定
+class LatencyRecorder {
+public:
+	LatencyRecorder() : seen(0), rng(1) {}
+
+	void add(double seconds);
+	LatencySummary summary() const;
+	void reset();
+
+private:
+	mutable mutex lock;
+	vector<double> samples;
+	long long seen;
+	SplitMix64 rng;
+};
+
+struct ServerOptions {
+	int port;                 // TCP 回环端口（unixPath 非空时不用）
+	string unixPath;          // Unix 域套接字文件
+	int batchRows;            // 一个微批最多的行数，攒够就立即预测
+	int maxDelayMicros;       // 微批里最早的请求最多等待这么久，到时不管攒了多少行都开始预测
+	int statsIntervalSeconds; // wait 期间每隔多久在 stderr 报告一次吞吐和延迟，0 表示不报告
+
+	ServerOptions() : port(5555), batchRows(256), maxDelayMicros(200), statsIntervalSeconds(5) {}
+};
+
+// 本机预测服务：每个连接一个读线程，把收到的请求放进队列；一个批处理线程把同时到达的请求拼成微批，
+// 用 ID3::predictBatch 一起预测，再把结果分别发回。延迟从请求完整收到算到响应发出
+class PredictionServer {
+public:
+	// model 在服务期间必须保持有效且不再修改
+	PredictionServer(const ID3& model, const ServerOptions& options);
+	~PredictionServer();
+
+	// 开始监听并启动后台线程，失败返回 false
+	bool start();
+
+	// 阻塞到 stop 被调用或者收到 SHUTDOWN 请求，期间定期报告统计
+	void wait();
+
+	// 停止监听，断开所有连接，等后台线程都退出后返回
+	void stop();
+
+	int port() const { return listener.localPort(); }
+
+	// 累计统计（请求数、行数、微批数、延迟分位数），JSON 格式
+	string statsJson() const;
+
+private:
+	struct Connection {
+		Socket socket;
+		mutex sendLock;                     // 批处理线程和读线程都可能发响应
+	};
+
+	struct Reader {
+		thread worker;
+		shared_ptr<Connection> connection;
+		shared_ptr<atomic<bool>> finished;
+	};
+
+	struct PendingRequest {
+		shared_ptr<Connection> connection;
+		unsigned int id;
+		int rows;
+		vector<int> codes;
+		chrono::steady_clock::time_point arrival;
+	};
+
+	const ID3& model;
+	ServerOptions options;
+	int num_attrs;
+
+	Socket listener;
+	thread accept_thread;
+	thread batch_thread;
+	mutex readers_lock;
+	vector<Reader> readers;
+
+	atomic<bool> stopping;            // 接收线程据此退出
+
+	mutex queue_lock;
+	condition_variable queue_ready;
+	deque<PendingRequest> queue;
+	int queued_rows;
+	bool queue_closed;                // 批处理线程处理完队列后退出
+	vector<int> batch_codes;          // 只由批处理线程使用
+	vector<int> batch_labels;
+
+	mutex state_lock;
+	condition_variable state_changed;
+	bool shutdown_requested;
+	bool running;
+
+	chrono::steady_clock::time_point started;
+	atomic<long long> total_requests;
+	atomic<long long> total_rows;
+	atomic<long long> total_batches;
+	LatencyRecorder latency;          // 启动以来
+	LatencyRecorder window_latency;   // 上次报告以来
+
+	// 把上次报告以来的吞吐和延迟写到 stderr
+	void report(chrono::steady_clock::time_point& last, long long& lastRequests, long long& lastRows, long long& lastBatches);
+
+	void acceptLoop();
+	void readLoop(shared_ptr<Connection> connection);
+	void batchLoop();
+
+	// 预测一个微批并发回各请求的响应
+	void runBatch(vector<PendingRequest>& batch);
+
+	static bool sendFrame(Connection& connection, unsigned int status, unsigned int id, unsigned int count, const void* payload, size_t bytes);
+
+	PredictionServer(const PredictionServer&) = delete;
+	PredictionServer& operator=(const PredictionServer&) = delete;
+};
+
+// 预测服务的客户端，一个对象对应一个连接（不是线程安全的）
+class PredictionClient {
+public:
+	PredictionClient() : next_id(1) {}
+
+	bool connectTcp(const string& host, int port) { return socket.connectTcp(host, port); }
+	bool connectUnix(const string& path) { return socket.connectUnix(path); }
+
+	// 发出一个预测请求但不等响应，codes 是 numRows 行 x numAttrs 列的行优先编码，返回请求号（失败返回 0）
+	unsigned int sendPredict(const int* codes, int numRows, int numAttrs);
+
+	// 接收下一个预测响应，labels 是每行的类别编码；连接断开或者状态不是 OK 时返回 false
+	bool receivePredict(unsigned int& id, vector<int>& labels);
+
+	// 同步预测：发出请求并等待它的响应
+	bool predict(const int* codes, int numRows, int numAttrs, vector<int>& labels);
+
+	// 取服务端统计（JSON）
+	bool serverStats(string& json);
+
+	// 让服务端退出
+	bool shutdownServer();
+
+private:
+	Socket socket;
+	unsigned int next_id;
+	vector<char> buffer;
+
+	bool sendRequest(unsigned int op, unsigned int id, unsigned int rows, const void* payload, size_t bytes);
+	bool receiveFrame(unsigned int& status, unsigned int& id, unsigned int& count, vector<char>& payload);
+};
\ No newline at end of file
@@ -0,0 +1,127 @@
+/* 2452214 霍宇哲 大数据 */
+#include "Profiler.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+static const char* const PHASE_NAMES[PHASE_COUNT] = {
+	"train", "metadata", "entropy", "gain", "split", "alloc", "compile"
+};
+
+// 给每个线程一个从 0 开始的小编号，trace 里按它分行显示
+static int currentThreadNumber() {
+	static atomic<int> nextNumber(0);
+	thread_local int number = nextNumber.fetch_add(1);
+	return number;
+}
+
+TrainStats::TrainStats() : enabled(false), rowsScanned(0), bytesAllocated(0), traceEvents(0), traceEventsDropped(0) {
+	for (int p = 0; p < PHASE_COUNT; ++p)
+		phaseSeconds[p] = 0;
+}
+
+long long TrainStats::nodeCount() const {
+	long long total = 0;
+	for (long long n : nodesPerDepth)
+		total += n;
+	return total;
+}
+
+string TrainStats::toJson() const {
+	ostringstream out;
+	out << "{\"enabled\":" << (enabled ? "true" : "false");
+	for (int p = 0; p < PHASE_COUNT; ++p)
+		out << ",\"" << PHASE_NAMES[p] << "_s\":" << phaseSeconds[p];
+	out << ",\"rows_scanned\":" << rowsScanned
+		<< ",\"bytes_allocated\":" << bytesAllocated
+		<< ",\"nodes\":" << nodeCount()
+		<< ",\"nodes_per_depth\":[";
+	for (size_t d = 0; d < nodesPerDepth.size(); ++d)
+		out << (d > 0 ? "," : "") << nodesPerDepth[d];
+	out << "],\"trace_events\":" << traceEvents
+		<< ",\"trace_events_dropped\":" << traceEventsDropped << "}";
+	return out.str();
+}
+
+Profiler::Profiler() : trace_enabled(false), dropped_events(0) {
+	reset(false);
+}
+
+void Profiler::reset(bool traceEvents) {
+	for (int p = 0; p < PHASE_COUNT; ++p)
+		phase_ns[p] = 0;
+	rows_scanned = 0;
+	bytes_allocated = 0;
+	for (int d = 0; d < PROFILE_MAX_DEPTH; ++d)
+		nodes_per_depth[d] = 0;
+
+	lock_guard<mutex> lock(trace_mutex);
+	trace_enabled = traceEvents;
+	origin = chrono::steady_clock::now();
+	events.clear();
+	dropped_events = 0;
+}
+
+void Profiler::addTime(ProfilePhase phase, chrono::steady_clock::time_point start, chrono::steady_clock::time_point end) {
+	long long ns = chrono::duration_cast<chrono::nanoseconds>(end - start).count();
+	phase_ns[phase].fetch_add(ns, memory_order_relaxed);
+
+	if (!trace_enabled)
+		return;
+	TraceEvent event;
+	event.phase = phase;
+	event.thread = currentThreadNumber();
+	event.startNs = chrono::duration_cast<chrono::nanoseconds>(start - origin).count();
+	event.durationNs = ns;
+
+	lock_guard<mutex> lock(trace_mutex);
+	if (events.size() < PROFILE_MAX_EVENTS)
+		events.push_back(event);
+	else
+		dropped_events++;
+}
+
+void Profiler::addNode(int depth) {
+	nodes_per_depth[min(depth, PROFILE_MAX_DEPTH - 1)].fetch_add(1, memory_order_relaxed);
+}
+
+TrainStats Profiler::snapshot() const {
+	TrainStats stats;
+#ifdef ID3_PROFILE
+	stats.enabled = true;
+#endif
+	for (int p = 0; p < PHASE_COUNT; ++p)
+		stats.phaseSeconds[p] = phase_ns[p].load() / 1e9;
+	stats.rowsScanned = rows_scanned.load();
+	stats.bytesAllocated = bytes_allocated.load();
+
+	int depth = PROFILE_MAX_DEPTH;
+	while (depth > 0 && nodes_per_depth[depth - 1].load() == 0)
+		depth--;
+	for (int d = 0; d < depth; ++d)
+		stats.nodesPerDepth.push_back(nodes_per_depth[d].load());
+
+	lock_guard<mutex> lock(trace_mutex);
+	stats.traceEvents = (long long)events.size();
+	stats.traceEventsDropped = dropped_events;
+	return stats;
+}
+
+bool Profiler::writeChromeTrace(const string& filename) const {
+	ofstream out(filename, ios::binary);
+	if (!out)
+		return false;
+
+	lock_guard<mutex> lock(trace_mutex);
+	out << "{\"traceEvents\":[\n";
+	for (size_t i = 0; i < events.size(); ++i) {
+		const TraceEvent& e = events[i];
+		out << (i > 0 ? ",\n" : "")
+			<< "{\"name\":\"" << PHASE_NAMES[e.phase] << "\",\"cat\":\"id3\",\"ph\":\"X\""
+			<< ",\"ts\":" << e.startNs / 1000.0
+			<< ",\"dur\":" << e.durationNs / 1000.0
+			<< ",\"pid\":1,\"tid\":" << e.thread << "}";
+	}
+	out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+	return (bool)out;
+}
\ No newline at end of file
@@ -0,0 +1,120 @@
+/* 2452214 霍宇哲 大数据 */
+#pragma once
+#include <vector>
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+
+using namespace std;
+
+// 训练过程的计时和计数
+// 只有定义了 ID3_PROFILE（编译选项 /DID3_PROFILE 或 -DID3_PROFILE）时下面的宏才会展开，
+// 否则它们连参数都不会求值，训练代码与没有插桩时完全相同；ID3 里的 Profiler 成员也只在这时存在，
+// 所以这个选项必须对整个工程统一打开或关闭
+
+#define ID3_PROFILE_CONCAT_INNER(a, b) a##b
+#define ID3_PROFILE_CONCAT(a, b) ID3_PROFILE_CONCAT_INNER(a, b)
+
+#ifdef ID3_PROFILE
+#define ID3_PROFILE_SCOPE(profiler, phase) ProfileScope ID3_PROFILE_CONCAT(profile_scope_, __LINE__)(profiler, phase)
+#define ID3_PROFILE_ROWS(profiler, rows) (profiler).addRows(rows)
+#define ID3_PROFILE_BYTES(profiler, bytes) (profiler).addBytes(bytes)
+#define ID3_PROFILE_NODE(profiler, depth) (profiler).addNode(depth)
+#define ID3_PROFILE_BEGIN(profiler, traceEvents) (profiler).reset(traceEvents)
+#define ID3_PROFILE_END(profiler, stats) ((stats) = (profiler).snapshot())
+#else
+#define ID3_PROFILE_SCOPE(profiler, phase) ((void)0)
+#define ID3_PROFILE_ROWS(profiler, rows) ((void)0)
+#define ID3_PROFILE_BYTES(profiler, bytes) ((void)0)
+#define ID3_PROFILE_NODE(profiler, depth) ((void)0)
+#define ID3_PROFILE_BEGIN(profiler, traceEvents) ((void)0)
+#define ID3_PROFILE_END(profiler, stats) ((void)0)
+#endif
+
+// 训练的各个阶段
+enum ProfilePhase {
+	PHASE_TRAIN,     // 整个 train
+	PHASE_METADATA,  // 建立属性映射、复制字典、初始化行号
+	PHASE_ENTROPY,   // 节点的类别统计：纯度检查、多数类、基础熵
+	PHASE_GAIN,      // 各候选属性的信息增益
+	PHASE_SPLIT,     // 按最佳属性原地划分行号
+	PHASE_ALLOC,     // 在 Arena 上分配节点
+	PHASE_COMPILE,   // 编译成扁平数组
+	PHASE_COUNT
+};
+
+const int PROFILE_MAX_DEPTH = 64;          // 更深的节点计入最后一格
+const size_t PROFILE_MAX_EVENTS = 1 << 20; // 最多记录的 trace 事件数，超过的丢弃
+
+// 一次训练的统计结果
+struct TrainStats {
+	bool enabled;                        // 编译时是否打开了 ID3_PROFILE，没打开时其余字段都是 0
+	double phaseSeconds[PHASE_COUNT];    // 各阶段累计耗时（秒），多线程时是各线程之和，PHASE_TRAIN 是墙钟时间
+	long long rowsScanned;               // 各阶段扫描行号的总次数
+	long long bytesAllocated;            // 在 Arena 上分配的字节数
+	vector<long long> nodesPerDepth;     // 每层创建的节点数（根为第 0 层）
+	long long traceEvents;               // 记录的 trace 事件数
+	long long traceEventsDropped;        // 超过上限而丢弃的事件数
+
+	TrainStats();
+
+	long long nodeCount() const;
+
+	// 输出为一个 JSON 对象
+	string toJson() const;
+};
+
+// 训练时的计数器，可以在多个线程里同时记录
+class Profiler {
+public:
+	Profiler();
+
+	// 开始一次新的训练，traceEvents 为 true 时同时记录每个区间，用于 Chrome trace
+	void reset(bool traceEvents);
+
+	void addTime(ProfilePhase phase, chrono::steady_clock::time_point start, chrono::steady_clock::time_point end);
+	void addRows(long long rows) { rows_scanned.fetch_add(rows, memory_order_relaxed); }
+	void addBytes(long long bytes) { bytes_allocated.fetch_add(bytes, memory_order_relaxed); }
+	void addNode(int depth);
+
+	TrainStats snapshot() const;
+
+	// 写成 Chrome trace 格式（chrome://tracing 或 Perfetto 可以打开），失败返回 false
+	bool writeChromeTrace(const string& filename) const;
+
+private:
+	struct TraceEvent {
+		ProfilePhase phase;
+		int thread;
+		long long startNs;
+		long long durationNs;
+	};
+
+	atomic<long long> phase_ns[PHASE_COUNT];
+	atomic<long long> rows_scanned;
+	atomic<long long> bytes_allocated;
+	atomic<long long> nodes_per_depth[PROFILE_MAX_DEPTH];
+
+	bool trace_enabled;
+	chrono::steady_clock::time_point origin;
+	mutable mutex trace_mutex;
+	vector<TraceEvent> events;
+	long long dropped_events;
+
+	Profiler(const Profiler&) = delete;
+	Profiler& operator=(const Profiler&) = delete;
+};
+
+// 作用域计时：构造时记下开始时间，析构时计入对应阶段
+class ProfileScope {
+public:
+	ProfileScope(Profiler& profiler, ProfilePhase phase)
+		: profiler(profiler), phase(phase), start(chrono::steady_clock::now()) {}
+	~ProfileScope() { profiler.addTime(phase, start, chrono::steady_clock::now()); }
+
+private:
+	Profiler& profiler;
+	ProfilePhase phase;
+	chrono::steady_clock::time_point start;
+};
\ No newline at end of file
@@ -0,0 +1,27 @@
+/* 2452214 霍宇哲 大数据 */
+#pragma once
+#include <cstdint>
+
+using namespace std;
+
+// SplitMix64 随机数：足够快，而且各平台结果一致（标准库的分布在不同实现上结果不同）
+class SplitMix64 {
+public:
+	explicit SplitMix64(uint64_t seed) : state(seed) {}
+
+	uint64_t next() {
+		uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	}
+
+	// [0, n) 内的整数
+	int below(int n) { return (int)(((next() >> 32) * (uint64_t)n) >> 32); }
+
+	// [0, 1) 内的实数
+	double unit() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+private:
+	uint64_t state;
+};
\ No newline at end of file
@@ -0,0 +1,144 @@
+/* 2452214 霍宇哲 大数据 */
+#include "RandomForest.h"
+#include "ThreadPool.h"
+#include "Random.h"
+#include <iostream>
+#include <cmath>
+#include <thread>
+#include <algorithm>
+
+RandomForest::RandomForest(const ForestOptions& options) : options(options), num_attrs(0), num_classes(0) {}
+
+// 各棵树互相独立，交给线程池并行训练；线程数为 1 时依次训练
+static void runParallel(int threads, int count, const function<void(int)>& fn) {
+	if (threads <= 0)
+		threads = (int)thread::hardware_concurrency();
+	if (threads > 1 && count > 1) {
+		ThreadPool pool(min(threads, count));
+		pool.parallelFor(count, fn);
+	}
+	else {
+		for (int i = 0; i < count; ++i)
+			fn(i);
+	}
+}
+
+bool RandomForest::train(const Dataset& data, const string& target) {
+	trees.clear();
+	const int targetIndex = data.findAttribute(target);
+	if (targetIndex < 0 || data.numRows() == 0) {
+		cerr << "错误: 数据集为空或没有目标列 " << target << endl;
+		return false;
+	}
+	num_attrs = data.numAttributes();
+	num_classes = data.dictionary(targetIndex).size();
+
+	int subset = options.featureSubset;
+	if (subset == 0)
+		subset = max(1, (int)sqrt((double)(num_attrs - 1)));
+	else if (subset < 0)
+		subset = 0;
+
+	// 所有树共享同一份字典（与 data 的字典相同），不为每棵树复制
+	vector<ValueDictionary> dicts;
+	for (int j = 0; j < num_attrs; ++j)
+		dicts.push_back(data.dictionary(j));
+	const shared_ptr<const vector<ValueDictionary>> shared = make_shared<const vector<ValueDictionary>>(move(dicts));
+
+	const int n = data.numRows();
+	trees.resize(max(1, options.trees));
+	runParallel(options.threads, (int)trees.size(), [&](int t) {
+		// 第 t 棵树自己的随机数：先取候选属性的种子，再做 bootstrap 抽样
+		SplitMix64 rng(((uint64_t)options.seed << 32) | (uint32_t)t);
+		unique_ptr<ID3> tree(new ID3());
+		tree->setFeatureSubset(subset, (unsigned int)rng.next());
+		tree->setNumericAttributes(options.numericAttributes);
+		tree->shareDictionaries(shared);
+		if (options.bootstrap) {
+			vector<int> weights(n, 0);
+			for (int i = 0; i < n; ++i)
+				weights[rng.below(n)]++;
+			tree->train(data, target, weights);
+		}
+		else {
+			tree->train(data, target);
+		}
+		trees[t] = move(tree);
+	});
+
+	// 各棵树共用 trees[0] 的编码：没见过的数按所有树阈值的并集分区间，对每棵树都精确
+	vector<vector<double>> thresholds;
+	for (const unique_ptr<ID3>& tree : trees)
+		tree->collectThresholds(thresholds);
+	for (const unique_ptr<ID3>& tree : trees)
+		tree->setEncodingThresholds(thresholds);
+	return true;
+}
+
+Dataset RandomForest::encodeBatch(const Dataset& data) const {
+	return trees.empty() ? Dataset() : trees[0]->encodeBatch(data);
+}
+
+int RandomForest::majority(const int* votes, int numClasses) {
+	int label = -1;
+	int best = 0;
+	for (int c = 0; c < numClasses; ++c) {
+		if (votes[c] > best) {
+			best = votes[c];
+			label = c;
+		}
+	}
+	return label;
+}
+
+vector<int> RandomForest::predictBatch(const Dataset& block) const {
+	const int n = block.numRows();
+	vector<int> result(n, -1);
+	if (trees.empty() || n == 0)
+		return result;
+
+	// 计票表只有一段行那么大，内存与 block 的行数和树的棵数都无关
+	const int tiles = (n + FOREST_PREDICT_ROWS - 1) / FOREST_PREDICT_ROWS;
+	runParallel(options.threads, tiles, [&](int tile) {
+		const int begin = tile * FOREST_PREDICT_ROWS;
+		const int end = min(n, begin + FOREST_PREDICT_ROWS);
+		const int count = end - begin;
+		vector<int> votes((size_t)count * num_classes, 0);
+		vector<int> predictions(count);
+		for (const unique_ptr<ID3>& tree : trees) {
+			tree->predictBatch(block, begin, end, predictions.data());
+			for (int i = 0; i < count; ++i)
+				if (predictions[i] >= 0)
+					votes[(size_t)i * num_classes + predictions[i]]++;
+		}
+		for (int i = 0; i < count; ++i)
+			result[begin + i] = majority(votes.data() + (size_t)i * num_classes, num_classes);
+	});
+	return result;
+}
+
+int RandomForest::predictCode(const int* codes) const {
+	vector<int> votes(num_classes, 0);
+	for (const unique_ptr<ID3>& tree : trees) {
+		int label = tree->predictCode(codes);
+		if (label >= 0)
+			votes[label]++;
+	}
+	return majority(votes.data(), num_classes);
+}
+
+string RandomForest::predict(const vector<string>& sample) const {
+	if (trees.empty())
+		return "Empty Tree";
+	if ((int)sample.size() > num_attrs)
+		return "测试集的维数错误";
+
+	// 与 encodeBatch 相同的编码，数值属性上没见过的数编码为所在的阈值区间
+	vector<int> codes(num_attrs, -1);
+	for (int j = 0; j < (int)sample.size(); ++j)
+		codes[j] = trees[0]->encodeValue(j, sample[j]);
+	int label = predictCode(codes.data());
+	if (label < 0)
+		return "未知的特征值";
+	return labelDictionary().value(label);
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+/* 2452214 霍宇哲 大数据 */
+#pragma once
+#include <vector>
+#include <string>
+#include <memory>
+#include "Dataset.h"
+#include "ID3.h"
+
+using namespace std;
+
+const int FOREST_PREDICT_ROWS = 1 << 12; // 森林批量预测时每段的行数，各段可以并行
+
+// 随机森林的参数
+struct ForestOptions {
+	int trees;                        // 树的棵数
+	int featureSubset;                // 每次分裂抽取的候选属性数，0 表示 sqrt(特征数)，负数表示使用全部
+	bool bootstrap;                   // 每棵树在有放回抽样得到的行权重上训练，否则使用全部行
+	unsigned int seed;
+	int threads;                      // 训练和批量预测的线程数（0 表示使用全部硬件线程），不影响结果
+	vector<string> numericAttributes; // 按数值阈值二分的列（见 ID3::setNumericAttributes）
+
+	ForestOptions() : trees(100), featureSubset(0), bootstrap(true), seed(42), threads(1) {}
+};
+
+// 随机森林：多棵 ID3 树分别在 bootstrap 抽样上训练，每次分裂只在随机的一部分属性中选择，预测时多数表决
+// 所有树共享调用方的同一个编码数据集：bootstrap 表示为每行的权重（行号重复的次数），不复制数据，
+// 训练期间额外的内存只有正在训练的几棵树的权重和行号数组，不随树的棵数增长；
+// 各棵树还共享一份列字典（ID3::shareDictionaries），每棵树自己只保存节点数组和数值属性的取值表
+// 第 t 棵树的抽样和候选属性只取决于 seed 和 t，所以结果与线程数无关
+class RandomForest {
+public:
+	explicit RandomForest(const ForestOptions& options = ForestOptions());
+
+	// 并行训练各棵树（每棵树内部串行）；目标列不存在或数据为空时返回 false
+	bool train(const Dataset& data, const string& target);
+
+	int treeCount() const { return (int)trees.size(); }
+	const ID3& tree(int i) const { return *trees[i]; }
+
+	// 把任意编码的数据集换成模型的编码（各棵树都使用训练数据的字典，没见过的数按所有树的阈值分区间）
+	Dataset encodeBatch(const Dataset& data) const;
+
+	// 批量多数表决：block 须使用模型的编码；按 FOREST_PREDICT_ROWS 行分段并行，
+	// 每段依次用各棵树批量预测再计票，票数相同时取编码较小的类别，所有树都无法预测的行为 -1
+	vector<int> predictBatch(const Dataset& block) const;
+
+	// 单行预测（编码样本），规则与 predictBatch 相同
+	int predictCode(const int* codes) const;
+
+	// 单行预测（字符串样本）：编码同 encodeBatch，数值属性上没见过的数也能预测，其余没见过的取值只让经过它的树弃权
+	string predict(const vector<string>& sample) const;
+
+	const ValueDictionary& labelDictionary() const { return trees[0]->labelDictionary(); }
+
+private:
+	ForestOptions options;
+	vector<unique_ptr<ID3>> trees;
+	int num_attrs;
+	int num_classes;
+
+	// 得票最多的类别（平局取编码小的），没有票时返回 -1
+	static int majority(const int* votes, int numClasses);
+};
\ No newline at end of file
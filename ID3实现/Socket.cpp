@@ -0,0 +1,273 @@
+/* 2452214 霍宇哲 大数据 */
+#include "Socket.h"
+#include <iostream>
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+typedef int socklen_t;
+#else
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+typedef SOCKET NativeSocket;
+
+// Winsock 在第一次使用前初始化一次
+static bool startup() {
+	static bool ok = [] {
+		WSADATA data;
+		return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+	}();
+	return ok;
+}
+
+static void closeNative(NativeSocket s) {
+	closesocket(s);
+}
+#else
+typedef int NativeSocket;
+
+static bool startup() {
+	return true;
+}
+
+static void closeNative(NativeSocket s) {
+	::close(s);
+}
+#endif
+
+static NativeSocket native(long long handle) {
+	return (NativeSocket)handle;
+}
+
+// 预测请求都很小，关掉 Nagle 算法，否则小包会被攒起来延迟发送
+static void setNoDelay(long long handle) {
+	int on = 1;
+	setsockopt(native(handle), IPPROTO_TCP, TCP_NODELAY, (const char*)&on, sizeof(on));
+}
+
+Socket::Socket() : handle(-1) {}
+
+Socket::~Socket() {
+	close();
+}
+
+Socket::Socket(Socket&& other) : handle(other.handle), unix_path(move(other.unix_path)) {
+	other.handle = -1;
+	other.unix_path.clear();
+}
+
+Socket& Socket::operator=(Socket&& other) {
+	if (this != &other) {
+		close();
+		handle = other.handle;
+		unix_path = move(other.unix_path);
+		other.handle = -1;
+		other.unix_path.clear();
+	}
+	return *this;
+}
+
+bool Socket::listenTcp(int port) {
+	close();
+	if (!startup())
+		return false;
+
+	NativeSocket s = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+	if (s == (NativeSocket)-1)
+		return false;
+	int on = 1;
+	setsockopt(s, SOL_SOCKET, SO_REUSEADDR, (const char*)&on, sizeof(on));
+
+	sockaddr_in addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons((unsigned short)port);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	if (bind(s, (const sockaddr*)&addr, sizeof(addr)) != 0 || listen(s, SOMAXCONN) != 0) {
+		cerr << "错误: 无法监听端口 " << port << endl;
+		closeNative(s);
+		return false;
+	}
+	handle = (long long)s;
+	return true;
+}
+
+bool Socket::listenUnix(const string& path) {
+	close();
+#ifdef _WIN32
+	cerr << "错误: 这个平台不支持 Unix 域套接字，请改用 TCP 端口" << endl;
+	(void)path;
+	return false;
+#else
+	sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (path.size() >= sizeof(addr.sun_path)) {
+		cerr << "错误: 套接字路径太长 " << path << endl;
+		return false;
+	}
+	memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+	NativeSocket s = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (s < 0)
+		return false;
+	unlink(path.c_str());
+	if (bind(s, (const sockaddr*)&addr, sizeof(addr)) != 0 || listen(s, SOMAXCONN) != 0) {
+		cerr << "错误: 无法监听 " << path << endl;
+		closeNative(s);
+		return false;
+	}
+	handle = s;
+	unix_path = path;
+	return true;
+#endif
+}
+
+bool Socket::connectTcp(const string& host, int port) {
+	close();
+	if (!startup())
+		return false;
+
+	addrinfo hints;
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_INET;
+	hints.ai_socktype = SOCK_STREAM;
+	addrinfo* result = nullptr;
+	if (getaddrinfo(host.c_str(), to_string(port).c_str(), &hints, &result) != 0 || !result)
+		return false;
+
+	NativeSocket s = socket(result->ai_family, result->ai_socktype, result->ai_protocol);
+	bool ok = s != (NativeSocket)-1 && connect(s, result->ai_addr, (socklen_t)result->ai_addrlen) == 0;
+	freeaddrinfo(result);
+	if (!ok) {
+		if (s != (NativeSocket)-1)
+			closeNative(s);
+		return false;
+	}
+	handle = (long long)s;
+	setNoDelay(handle);
+	return true;
+}
+
+bool Socket::connectUnix(const string& path) {
+	close();
+#ifdef _WIN32
+	(void)path;
+	return false;
+#else
+	sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (path.size() >= sizeof(addr.sun_path))
+		return false;
+	memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+	NativeSocket s = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (s < 0)
+		return false;
+	if (connect(s, (const sockaddr*)&addr, sizeof(addr)) != 0) {
+		closeNative(s);
+		return false;
+	}
+	handle = s;
+	return true;
+#endif
+}
+
+bool Socket::accept(Socket& client, int timeoutMs) {
+	if (handle == -1)
+		return false;
+
+	// 先用 select 等待，这样停止服务时监听线程最多 timeoutMs 后就能发现
+	fd_set readable;
+	FD_ZERO(&readable);
+	FD_SET(native(handle), &readable);
+	timeval timeout;
+	timeout.tv_sec = timeoutMs / 1000;
+	timeout.tv_usec = (timeoutMs % 1000) * 1000;
+	if (select((int)(native(handle) + 1), &readable, nullptr, nullptr, &timeout) <= 0)
+		return false;
+
+	NativeSocket s = ::accept(native(handle), nullptr, nullptr);
+	if (s == (NativeSocket)-1)
+		return false;
+	client.close();
+	client.handle = (long long)s;
+	if (unix_path.empty())
+		setNoDelay(client.handle);
+	return true;
+}
+
+bool Socket::sendAll(const void* data, size_t size) {
+	const char* p = (const char*)data;
+	while (size > 0) {
+		int chunk = (int)min<size_t>(size, 1 << 30);
+#if defined(MSG_NOSIGNAL)
+		int sent = (int)send(native(handle), p, chunk, MSG_NOSIGNAL); // 对方已关闭时返回错误，而不是收到 SIGPIPE
+#else
+		int sent = (int)send(native(handle), p, chunk, 0);
+#endif
+		if (sent <= 0)
+			return false;
+		p += sent;
+		size -= sent;
+	}
+	return true;
+}
+
+bool Socket::recvAll(void* data, size_t size) {
+	char* p = (char*)data;
+	while (size > 0) {
+		int chunk = (int)min<size_t>(size, 1 << 30);
+		int received = (int)recv(native(handle), p, chunk, 0);
+		if (received <= 0)
+			return false;
+		p += received;
+		size -= received;
+	}
+	return true;
+}
+
+int Socket::localPort() const {
+	sockaddr_in addr;
+	socklen_t length = sizeof(addr);
+	if (handle == -1 || getsockname(native(handle), (sockaddr*)&addr, &length) != 0)
+		return -1;
+	return ntohs(addr.sin_port);
+}
+
+void Socket::shutdownBoth() {
+	if (handle == -1)
+		return;
+#ifdef _WIN32
+	::shutdown(native(handle), SD_BOTH);
+#else
+	::shutdown(native(handle), SHUT_RDWR);
+#endif
+}
+
+void Socket::close() {
+	if (handle == -1)
+		return;
+	closeNative(native(handle));
+	handle = -1;
+	if (!unix_path.empty()) {
+		remove(unix_path.c_str());
+		unix_path.clear();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+/* 2452214 霍宇哲 大数据 */
+#pragma once
+#include <string>
+#include <cstddef>
+
+using namespace std;
+
+// 阻塞式的流套接字：TCP 回环或者 Unix 域套接字，Windows 上用 Winsock，其余平台用 BSD socket
+// 只能移动不能复制，析构时关闭；出错时函数返回 false，不抛异常
+class Socket {
+public:
+	Socket();
+	~Socket();
+	Socket(Socket&& other);
+	Socket& operator=(Socket&& other);
+
+	// 在 127.0.0.1:port 上监听，只接受本机的连接；port 为 0 时由系统分配，用 localPort 查询
+	bool listenTcp(int port);
+
+	// 在 Unix 域套接字文件 path 上监听（已有的同名文件会被替换，关闭时删除）；Windows 上不支持，返回 false
+	bool listenUnix(const string& path);
+
+	bool connectTcp(const string& host, int port);
+	bool connectUnix(const string& path);
+
+	// 最多等待 timeoutMs 毫秒接受一个新连接，超时或出错返回 false
+	bool accept(Socket& client, int timeoutMs);
+
+	// 完整地发送 / 接收 size 字节，对方关闭或出错返回 false
+	bool sendAll(const void* data, size_t size);
+	bool recvAll(void* data, size_t size);
+
+	// 监听的 TCP 端口，失败返回 -1
+	int localPort() const;
+
+	bool isOpen() const { return handle != -1; }
+
+	// 关闭两个方向，阻塞在 recv 上的其它线程会立即返回（用于停止服务）
+	void shutdownBoth();
+	void close();
+
+private:
+	long long handle;   // Windows 的 SOCKET 或者 POSIX 的文件描述符，-1 表示没有打开
+	string unix_path;   // 监听的 Unix 域套接字文件
+
+	Socket(const Socket&) = delete;
+	Socket& operator=(const Socket&) = delete;
+};
\ No newline at end of file
@@ -0,0 +1,138 @@
+/* 2452214 霍宇哲 大数据 */
+#include "ThreadPool.h"
+
+// 记录当前线程属于哪个线程池的哪个队列
+static thread_local const ThreadPool* tls_pool = nullptr;
+static thread_local int tls_queue = 0;
+
+ThreadPool::ThreadPool(int threads) : queued(0), stopping(false) {
+	if (threads < 1)
+		threads = 1;
+	for (int i = 0; i < threads; ++i) {
+		queues.emplace_back(new WorkQueue());
+	}
+	for (int i = 1; i < threads; ++i) {
+		workers.emplace_back(&ThreadPool::workerLoop, this, i);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		lock_guard<mutex> lock(sleepMutex);
+		stopping = true;
+	}
+	sleepCond.notify_all();
+	for (auto& t : workers)
+		t.join();
+}
+
+int ThreadPool::currentQueue() const {
+	return tls_pool == this ? tls_queue : 0;
+}
+
+void ThreadPool::run(TaskGroup& group, function<void()> task) {
+	group.pending++;
+	if (queues.size() == 1) {
+		// 单线程时直接执行
+		Task t{ move(task), &group };
+		execute(t);
+		return;
+	}
+
+	WorkQueue& q = *queues[currentQueue()];
+	{
+		lock_guard<mutex> lock(q.mtx);
+		q.tasks.push_back(Task{ move(task), &group });
+	}
+	queued++;
+	{
+		lock_guard<mutex> lock(sleepMutex);
+	}
+	sleepCond.notify_one();
+}
+
+bool ThreadPool::popLocal(int self, Task& task) {
+	WorkQueue& q = *queues[self];
+	lock_guard<mutex> lock(q.mtx);
+	if (q.tasks.empty())
+		return false;
+	task = move(q.tasks.back());
+	q.tasks.pop_back();
+	return true;
+}
+
+bool ThreadPool::steal(int self, Task& task) {
+	int n = (int)queues.size();
+	for (int k = 1; k < n; ++k) {
+		WorkQueue& q = *queues[(self + k) % n];
+		lock_guard<mutex> lock(q.mtx);
+		if (!q.tasks.empty()) {
+			task = move(q.tasks.front());
+			q.tasks.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
+
+void ThreadPool::execute(Task& task) {
+	task.fn();
+	if (--task.group->pending == 0) {
+		// 唤醒可能在 wait 里休眠的线程（加锁保证它不会错过这次通知）
+		{
+			lock_guard<mutex> lock(sleepMutex);
+		}
+		sleepCond.notify_all();
+	}
+}
+
+bool ThreadPool::tryRunOne(int self) {
+	Task task;
+	if (!popLocal(self, task) && !steal(self, task))
+		return false;
+	queued--;
+	execute(task);
+	return true;
+}
+
+void ThreadPool::wait(TaskGroup& group) {
+	int self = currentQueue();
+	while (group.pending > 0) {
+		if (tryRunOne(self))
+			continue;
+
+		// 没有能偷的任务：休眠到有新任务提交或者这一组全部完成
+		unique_lock<mutex> lock(sleepMutex);
+		sleepCond.wait(lock, [&] { return group.pending == 0 || queued > 0; });
+	}
+}
+
+void ThreadPool::workerLoop(int index) {
+	tls_pool = this;
+	tls_queue = index;
+	while (true) {
+		if (tryRunOne(index))
+			continue;
+
+		unique_lock<mutex> lock(sleepMutex);
+		sleepCond.wait(lock, [&] { return stopping || queued > 0; });
+		if (stopping)
+			return;
+	}
+}
+
+void ThreadPool::parallelFor(int count, const function<void(int)>& fn) {
+	if (queues.size() == 1 || count <= 1) {
+		for (int i = 0; i < count; ++i)
+			fn(i);
+		return;
+	}
+
+	// 下标 1 ~ count-1 作为任务提交，下标 0 由当前线程直接执行
+	TaskGroup group;
+	for (int i = 1; i < count; ++i) {
+		run(group, [&fn, i] { fn(i); });
+	}
+	fn(0);
+	wait(group);
+}
\ No newline at end of file
@@ -0,0 +1,70 @@
+/* 2452214 霍宇哲 大数据 */
+#pragma once
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+using namespace std;
+
+// 一组相关任务，用于等待它们全部完成
+class TaskGroup {
+public:
+	TaskGroup() : pending(0) {}
+
+private:
+	friend class ThreadPool;
+	atomic<int> pending; // 尚未完成的任务数
+};
+
+// 工作窃取线程池：每个线程有自己的任务队列，自己从队尾取（后进先出，局部性好），
+// 空闲线程从别人的队头偷（先进先出，偷到的通常是较大的任务）
+// 任务可以在任务内部继续提交和等待（嵌套并行），等待期间当前线程会帮忙执行其它任务
+// 调用线程本身也参与执行，所以 threads 个线程里只额外创建 threads - 1 个工作线程
+class ThreadPool {
+public:
+	explicit ThreadPool(int threads);
+	~ThreadPool();
+
+	int size() const { return (int)queues.size(); }
+
+	// 提交一个属于 group 的任务
+	void run(TaskGroup& group, function<void()> task);
+
+	// 等待 group 中的任务全部完成，等待期间帮忙执行任务，没有任务可做时休眠而不是空转
+	void wait(TaskGroup& group);
+
+	// 并行执行 fn(0) ... fn(count - 1)，全部完成后返回
+	void parallelFor(int count, const function<void(int)>& fn);
+
+	// 当前线程对应的队列下标，在 [0, size()) 内且各线程互不相同；外部调用线程（以及不属于本线程池的线程）为 0
+	int currentQueue() const;
+
+private:
+	struct Task {
+		function<void()> fn;
+		TaskGroup* group;
+	};
+
+	struct WorkQueue {
+		mutex mtx;
+		deque<Task> tasks;
+	};
+
+	vector<unique_ptr<WorkQueue>> queues; // queues[0] 属于外部调用线程，其余各属于一个工作线程
+	vector<thread> workers;
+	atomic<int> queued;                   // 所有队列中的任务总数
+	atomic<bool> stopping;
+	mutex sleepMutex;
+	condition_variable sleepCond;         // 没有任务时工作线程和 wait 中的线程在这里休眠
+
+	bool popLocal(int self, Task& task);
+	bool steal(int self, Task& task);
+	bool tryRunOne(int self);             // 取一个任务执行，没有任务返回 false
+	void execute(Task& task);
+	void workerLoop(int index);
+};
\ No newline at end of file
@@ -1,8 +1,10 @@
-/* 2452214   */
+/* 2452214 霍宇哲 大数据 */
 #include "ID3.h"
+#include "CsvReader.h"
+#include "DatasetCache.h"
+#include "CrossValidation.h"
+#include "Discretizer.h"
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <vector>
 #include <string>
 #include <random>
@@ -12,45 +14,61 @@
 
 using namespace std;
 
-const int SEED = 42;    //ֽݼΪѵͲԼ
-// 
-vector<vector<string>> loadData(const string& filename, vector<string>& attributeNames);
-vector<string> splitLine(const string& line, char delimiter);
-double calculateAccuracy(const ID3& tree, const vector<vector<string>>& testData, int targetIndex);
-string discretizeGrade(const string& gradeStr);
-void printConfusionMatrix(const ID3& tree, const vector<vector<string>>& testData, int targetIndex);
+const int SEED = 42;    //分解数据集成为训练集和测试集的种子
+const string DATA_FILE = "student-mat.csv";
+const string CACHE_FILE = "student-mat.id3d"; // 预处理后的二进制缓存
+const string MODEL_FILE = "student-mat.id3m"; // 训练好的模型，评分服务直接加载，不需要重新训练
+const int CV_FOLDS = 10;   // 交叉验证的折数
+const int CV_REPEATS = 3;  // 交叉验证的重复次数
+const vector<string> NUMERIC_ATTRIBUTES = { "age", "absences", "G1", "G2" }; // 按数值阈值二分的列，不再每个取值一个分支
+// 函数声明
+Dataset loadData(const string& filename);
+vector<string> predictAll(const ID3& tree, const Dataset& testData);
+double calculateAccuracy(const vector<string>& predictions, const Dataset& testData, int targetIndex);
+void printConfusionMatrix(const vector<string>& predictions, const Dataset& testData, int targetIndex);
+void printCrossValidation(const CrossValidationResult& cv, const ValueDictionary& labels);
+void printPruneStats(const PruneStats& stats, double accuracyBefore, double accuracyAfter);
 
 int main() {
 	cout << "==========================================" << endl;
-	cout << "       ѧɼԤϵͳ - ID3" << endl;
-	cout << "       ʹѧγ (student-mat)" << endl;
+	cout << "       学生成绩预测系统 - ID3决策树" << endl;
+	cout << "       使用数学课程数据 (student-mat)" << endl;
 	cout << "==========================================" << endl;
 
-	// 1. 
-	cout << "\n[1] ڼ..." << endl;
-	vector<string> attributeNames;
-	vector<vector<string>> allData = loadData("student-mat.csv", attributeNames);
+	// 1. 加载数据
+	cout << "\n[1] 正在加载数据..." << endl;
+	// 缓存比 CSV 新时直接映射缓存，跳过文本解析和预处理
+	bool fromCache = isDatasetCacheFresh(CACHE_FILE, DATA_FILE);
+	Dataset allData;
+	if (fromCache && loadDatasetCache(CACHE_FILE, allData)) {
+		cout << "     从缓存 " << CACHE_FILE << " 读取 " << allData.numRows() << " 行数据" << endl;
+	}
+	else {
+		fromCache = false;
+		allData = loadData(DATA_FILE);
+	}
+	vector<string> attributeNames = allData.attributeNames();
 
-	if (allData.empty()) {
-		cerr << ": ޷ļ!" << endl;
+	if (allData.numRows() == 0) {
+		cerr << "错误: 无法加载数据文件!" << endl;
 		return 1;
 	}
 
-	cout << "     ɹ " << allData.size() << " ѧ¼" << endl;
-	cout << "     : " << attributeNames.size() << endl;
+	cout << "     成功加载 " << allData.numRows() << " 条学生记录" << endl;
+	cout << "     属性数量: " << attributeNames.size() << endl;
 
-	// ʾб
-	cout << "     б: ";
+	// 显示属性列表
+	cout << "     属性列表: ";
 	for (size_t i = 0; i < min((size_t)10, attributeNames.size()); i++) {
 		cout << attributeNames[i] << " ";
 	}
 	if (attributeNames.size() > 10) cout << "...";
 	cout << endl;
 
-	// 2. Ԥ
-	cout << "\n[2] Ԥ..." << endl;
+	// 2. 预处理数据
+	cout << "\n[2] 正在预处理数据..." << endl;
 
-	// ĿΪճɼG332У32
+	// 设置目标属性为最终成绩G3（第32列，索引32）
 	string targetAttribute = "G3";
 	int targetIndex = -1;
 	for (size_t i = 0; i < attributeNames.size(); i++) {
@@ -61,8 +79,8 @@ int main() {
 	}
 
 	if (targetIndex == -1) {
-		cerr << ": ҲĿ '" << targetAttribute << "'" << endl;
-		cerr << "õ: ";
+		cerr << "错误: 找不到目标属性 '" << targetAttribute << "'" << endl;
+		cerr << "可用的属性: ";
 		for (const auto& attr : attributeNames) {
 			cerr << attr << " ";
 		}
@@ -70,226 +88,210 @@ int main() {
 		return 1;
 	}
 
-	cout << "     Ŀ: " << targetAttribute << " (: " << targetIndex << ")" << endl;
-	cout << "     Ŀλ: " << targetIndex + 1 << "У1ʼ" << endl;
+	cout << "     目标属性: " << targetAttribute << " (索引: " << targetIndex << ")" << endl;
+	cout << "     目标属性位置: 第" << targetIndex + 1 << "列（从1开始计数）" << endl;
+
+	// 对G3成绩进行离散化（每个不同的成绩只解析一次，逐行只查表），缓存中的数据已经离散化过
+	if (!fromCache) {
+		Discretizer grades;
+		grades.setCuts(targetAttribute, { 9.5, 14.5 }, { "不及格", "中等", "优秀" });
+		grades.transform(allData);
+		if (!saveDatasetCache(allData, CACHE_FILE))
+			cerr << "     警告: 无法写入缓存 " << CACHE_FILE << endl;
+	}
 
-	// G3ɼɢ
 	map<string, int> gradeDistribution;
-	for (auto& row : allData) {
-		string originalGrade = row[targetIndex];
-		string discretizedGrade = discretizeGrade(originalGrade);
-		row[targetIndex] = discretizedGrade;
-		gradeDistribution[discretizedGrade]++;
+	for (int code : allData.column(targetIndex)) {
+		gradeDistribution[allData.dictionary(targetIndex).value(code)]++;
 	}
 
-	cout << "     ѽG3ɼɢΪ: (0-9), е(10-14), (15-20)" << endl;
-	cout << "     ɼֲͳ:" << endl;
+	cout << "     已将G3成绩离散化为: 不及格(0-9), 中等(10-14), 优秀(15-20)" << endl;
+	cout << "     成绩分布统计:" << endl;
 	for (const auto& pair : gradeDistribution) {
-		double percentage = (double)pair.second / allData.size() * 100;
-		cout << "        " << pair.first << ": " << pair.second << " ("
+		double percentage = (double)pair.second / allData.numRows() * 100;
+		cout << "        " << pair.first << ": " << pair.second << "人 ("
 			<< fixed << setprecision(1) << percentage << "%)" << endl;
 	}
 
-	// 3. ѵͲԼ
-	cout << "\n[3] ڻѵͲԼ..." << endl;
+	// 3. 划分训练集和测试集
+	cout << "\n[3] 正在划分训练集和测试集..." << endl;
 
-	// Ϊ˿ظԣʹù̶
-	unsigned int seed = SEED; // ̶ȷظ
+	// 为了可重复性，使用固定种子
+	unsigned int seed = SEED; // 固定种子以确保可重复性
 	mt19937 g(seed);
-	shuffle(allData.begin(), allData.end(), g); //allDataΪѵͲԼ
+	vector<int> order(allData.numRows());
+	for (int i = 0; i < allData.numRows(); i++) {
+		order[i] = i;
+	}
+	shuffle(order.begin(), order.end(), g); //随机划分allData成为训练集和测试集（只打乱行号）
 
-	// 80%ѵ20%
-	size_t trainSize = allData.size() * 0.8;
-	vector<vector<string>> trainData(allData.begin(), allData.begin() + trainSize);
-	vector<vector<string>> testData(allData.begin() + trainSize, allData.end());
+	// 80%训练，20%测试
+	size_t trainSize = allData.numRows() * 0.8;
+	Dataset trainData = allData.select(vector<int>(order.begin(), order.begin() + trainSize));
+	Dataset testData = allData.select(vector<int>(order.begin() + trainSize, order.end()));
 
-	cout << "     ѵС: " << trainData.size() << " ¼" << endl;
-	cout << "     ԼС: " << testData.size() << " ¼" << endl;
-	cout << "     ֱ: 80%ѵ / 20%" << endl;
+	cout << "     训练集大小: " << trainData.numRows() << " 条记录" << endl;
+	cout << "     测试集大小: " << testData.numRows() << " 条记录" << endl;
+	cout << "     划分比例: 80%训练 / 20%测试" << endl;
 
-	// 4. ѵ
-	cout << "\n[4] ѵID3..." << endl;
+	// 4. 训练决策树
+	cout << "\n[4] 正在训练ID3决策树..." << endl;
 	ID3 decisionTree;
+	decisionTree.setNumericAttributes(NUMERIC_ATTRIBUTES);
 	try {
-		decisionTree.train(trainData, attributeNames, targetAttribute);
-		cout << "     ѵ!" << endl;
+		decisionTree.train(trainData, targetAttribute);
+		cout << "     决策树训练完成! 共 " << decisionTree.nodeCount() << " 个节点" << endl;
+		if (decisionTree.save(MODEL_FILE))
+			cout << "     模型已保存到 " << MODEL_FILE << endl;
 	}
 	catch (const exception& e) {
-		cerr << "     ѵʧ: " << e.what() << endl;
+		cerr << "     训练失败: " << e.what() << endl;
 		return 1;
 	}
 
-	// 5. ģ
-	cout << "\n[5] ڲģ..." << endl;
-	double accuracy = calculateAccuracy(decisionTree, testData, targetIndex);
+	// 5. 测试模型性能
+	cout << "\n[5] 正在测试模型性能..." << endl;
+	// 整个测试集只批量预测一次，准确率和混淆矩阵共用结果
+	vector<string> predictions = predictAll(decisionTree, testData);
+	double accuracy = calculateAccuracy(predictions, testData, targetIndex);
 	cout << fixed << setprecision(2);
-	cout << "     Լ׼ȷ: " << accuracy * 100 << "%" << endl;
+	cout << "     测试集准确率: " << accuracy * 100 << "%" << endl;
 
-	// ʾ
-	printConfusionMatrix(decisionTree, testData, targetIndex);
+	// 显示混淆矩阵
+	printConfusionMatrix(predictions, testData, targetIndex);
 
-	// 6. һЩԤʾ
-	cout << "\n[6] Ԥʾ:" << endl;
+	// 6. 进行一些预测示例
+	cout << "\n[6] 预测示例:" << endl;
 	cout << "------------------------------------------" << endl;
 
-	if (!testData.empty()) {
-		// Ԥǰ5
-		for (int i = 0; i < min(5, (int)testData.size()); i++) {
-			// ԤõԣĿԱԭֵ
-			vector<string> predictionSample = testData[i];
-			string actual = testData[i][targetIndex];
+	if (testData.numRows() > 0) {
+		// 预测前5个测试样本
+		for (int i = 0; i < min(5, testData.numRows()); i++) {
+			// 创建预测用的样本（包含所有属性，目标属性保持原值）
+			vector<string> predictionSample = testData.row(i);
+			string actual = testData.valueAt(i, targetIndex);
 
 			string predicted = decisionTree.predict(predictionSample);
 
-			cout << " " << (i + 1) << ":" << endl;
-			cout << "  ʵG3ȼ: " << actual << endl;
-			cout << "  ԤG3ȼ: " << predicted;
+			cout << "样本 " << (i + 1) << ":" << endl;
+			cout << "  实际G3等级: " << actual << endl;
+			cout << "  预测G3等级: " << predicted;
 
 			if (predicted == actual) {
-				cout << "  ȷ" << endl;
+				cout << "  正确" << endl;
 			}
 			else if (predicted.find("Error") != string::npos ||
-				predicted.find("") != string::npos ||
-				predicted.find("δ֪") != string::npos ||
+				predicted.find("错误") != string::npos ||
+				predicted.find("未知") != string::npos ||
 				predicted.find("Empty") != string::npos) {
-				cout << "  Ԥ: " << predicted << endl;
+				cout << "  预测错误: " << predicted << endl;
 			}
 			else {
-				cout << "   (ԤΪ" << predicted << ")" << endl;
+				cout << "  错误 (预测为" << predicted << ")" << endl;
 			}
 
-			// ʾһЩؼ
-			cout << "  ؼ: ";
-			cout << "ѧУ=" << testData[i][0] << ", ";
-			cout << "Ա=" << testData[i][1] << ", ";
-			cout << "=" << testData[i][2] << ", ";
-			cout << "ѧϰʱ=" << testData[i][13] << ", ";
-			cout << "ʧܴ=" << testData[i][14] << ", ";
-			cout << "ȱ=" << testData[i][29] << ", ";
-			cout << "G1ɼ=" << testData[i][30] << ", ";
-			cout << "G2ɼ=" << testData[i][31] << endl;
+			// 显示一些关键特征
+			cout << "  关键特征: ";
+			cout << "学校=" << testData.valueAt(i, 0) << ", ";
+			cout << "性别=" << testData.valueAt(i, 1) << ", ";
+			cout << "年龄=" << testData.valueAt(i, 2) << ", ";
+			cout << "学习时间=" << testData.valueAt(i, 13) << ", ";
+			cout << "失败次数=" << testData.valueAt(i, 14) << ", ";
+			cout << "缺勤=" << testData.valueAt(i, 29) << ", ";
+			cout << "G1成绩=" << testData.valueAt(i, 30) << ", ";
+			cout << "G2成绩=" << testData.valueAt(i, 31) << endl;
 			cout << endl;
 		}
 	}
 
+	// 7. 交叉验证：单次 80/20 划分的准确率波动较大，用重复的分层 k 折交叉验证估计
+	// 各折只是 allData 上的行号列表，不复制数据，多个折同时训练
+	cout << "\n[7] 正在进行" << CV_FOLDS << "折分层交叉验证（重复" << CV_REPEATS << "次）..." << endl;
+	CrossValidationOptions cvOptions;
+	cvOptions.folds = CV_FOLDS;
+	cvOptions.repeats = CV_REPEATS;
+	cvOptions.seed = SEED;
+	cvOptions.threads = 0;
+	CrossValidationResult cv = crossValidate(allData, targetAttribute, cvOptions,
+		[](ID3& tree) { tree.setNumericAttributes(NUMERIC_ATTRIBUTES); });
+	printCrossValidation(cv, allData.dictionary(targetIndex));
+
+	// 8. 后剪枝：减少错误剪枝需要独立的验证集，从训练集中再分出 1/4 来；悲观剪枝只用训练数据，直接剪已保存的模型
+	cout << "\n[8] 正在对决策树进行后剪枝..." << endl;
+	size_t growSize = trainSize * 0.75;
+	Dataset growData = allData.select(vector<int>(order.begin(), order.begin() + growSize));
+	Dataset validationData = allData.select(vector<int>(order.begin() + growSize, order.begin() + trainSize));
+	ID3 repTree;
+	repTree.setNumericAttributes(NUMERIC_ATTRIBUTES);
+	repTree.train(growData, targetAttribute);
+	double repBefore = calculateAccuracy(predictAll(repTree, testData), testData, targetIndex);
+	PruneStats repStats;
+	if (repTree.pruneReducedError(growData, validationData, &repStats)) {
+		cout << "     减少错误剪枝 (" << growData.numRows() << " 行训练, " << validationData.numRows() << " 行验证):" << endl;
+		printPruneStats(repStats, repBefore, calculateAccuracy(predictAll(repTree, testData), testData, targetIndex));
+	}
+
+	ID3 pepTree;
+	PruneStats pepStats;
+	if (pepTree.load(MODEL_FILE)) {
+		double pepBefore = calculateAccuracy(predictAll(pepTree, testData), testData, targetIndex);
+		if (pepTree.prunePessimistic(trainData, &pepStats)) {
+			cout << "     悲观剪枝 (" << MODEL_FILE << "):" << endl;
+			printPruneStats(pepStats, pepBefore, calculateAccuracy(predictAll(pepTree, testData), testData, targetIndex));
+		}
+	}
+
 	cout << "\n==========================================" << endl;
-	cout << "           ִ" << endl;
+	cout << "           程序执行完毕" << endl;
 	cout << "==========================================" << endl;
 
 	return 0;
 }
 
-// CSV
-vector<vector<string>> loadData(const string& filename, vector<string>& attributeNames) {
-	vector<vector<string>> data;
-	ifstream file(filename, ios::in);
+// 加载CSV数据（内存映射，直接编码为列式数据集）
+Dataset loadData(const string& filename) {
+	Dataset data;
 
-	if (!file.is_open()) {
-		cerr << ": ޷ļ " << filename << endl;
-		cerr << "ȷļڵǰĿ¼: " << endl;
+	if (!loadCsv(filename, ';', data)) {
+		cerr << "错误: 无法打开文件 " << filename << endl;
+		cerr << "请确保文件存在于当前目录: " << endl;
 		return data;
 	}
 
-	string line;
-	int lineCount = 0;
-
-	// ȡһУ
-	if (getline(file, line)) {
-		lineCount++;
-		attributeNames = splitLine(line, ';');
-		cout << "     ȡ " << attributeNames.size() << " " << endl;
-	}
-
-	// ȡ
-	while (getline(file, line)) {
-		lineCount++;
-		vector<string> row = splitLine(line, ';');
-
-		// Ƿƥ
-		if (row.size() != attributeNames.size()) {
-			cerr << ":  " << lineCount << "  " << row.size()
-				<< " У " << attributeNames.size() << " " << endl;
-			cerr << ": " << line << endl;
-
-			// ޸㣬ֵ
-			while (row.size() < attributeNames.size()) {
-				row.push_back("");
-			}
-
-			// ࣬ض
-			if (row.size() > attributeNames.size()) {
-				row.resize(attributeNames.size());
-			}
-		}
-
-		data.push_back(row);
-	}
-
-	file.close();
-	cout << "     ɹȡ " << data.size() << " " << endl;
+	cout << "     读取到 " << data.numAttributes() << " 个属性名" << endl;
+	cout << "     成功读取 " << data.numRows() << " 行数据" << endl;
 	return data;
 }
 
-// ָCSV
-vector<string> splitLine(const string& line, char delimiter) {
-	vector<string> tokens;
-	string token;
-	istringstream tokenStream(line);
-
-	while (getline(tokenStream, token, delimiter)) {
-		// Ƴܵ
-		if (!token.empty()) {
-			if (token.front() == '"' && token.back() == '"') {
-				token = token.substr(1, token.size() - 2);
-			}
-			else if (token.front() == '\'' && token.back() == '\'') {
-				token = token.substr(1, token.size() - 2);
-			}
-		}
-		tokens.push_back(token);
-	}
-
-	return tokens;
-}
-
-// ɢɼ
-string discretizeGrade(const string& gradeStr) {
-	if (gradeStr.empty()) {
-		return "δ֪";
-	}
+// 批量预测整个测试集：编码一次后调用 predictBatch，再把类别编码解码回字符串
+vector<string> predictAll(const ID3& tree, const Dataset& testData) {
+	Dataset block = tree.encodeBatch(testData);
+	vector<int> codes = tree.predictBatch(block);
 
-	int grade = stoi(gradeStr);
-	if (grade >= 0 && grade <= 9) {
-		return "";
-	}
-	else if (grade >= 10 && grade <= 14) {
-		return "е";
-	}
-	else if (grade >= 15 && grade <= 20) {
-		return "";
-	}
-	else {
-		return "Чɼ";
+	vector<string> predictions(codes.size());
+	for (size_t i = 0; i < codes.size(); i++) {
+		predictions[i] = codes[i] < 0 ? "未知的特征值" : tree.labelDictionary().value(codes[i]);
 	}
+	return predictions;
 }
 
-// ׼ȷ
-double calculateAccuracy(const ID3& tree, const vector<vector<string>>& testData, int targetIndex) {
-	if (testData.empty()) return 0.0;
+// 计算准确率
+double calculateAccuracy(const vector<string>& predictions, const Dataset& testData, int targetIndex) {
+	if (testData.numRows() == 0) return 0.0;
 
 	int correct = 0;
 	int total = 0;
 
-	for (const auto& sample : testData) {
-		string actual = sample[targetIndex];
-		string predicted = tree.predict(sample);
+	for (int i = 0; i < testData.numRows(); i++) {
+		const string& actual = testData.valueAt(i, targetIndex);
+		const string& predicted = predictions[i];
 
-		// ԤǷЧ
+		// 检查预测是否有效
 		if (predicted == "Empty Tree" ||
 			predicted.find("Error") != string::npos ||
-			predicted.find("") != string::npos ||
-			predicted.find("δ֪") != string::npos) {
-			// Ԥʧܣ
+			predicted.find("错误") != string::npos ||
+			predicted.find("未知") != string::npos) {
+			// 预测失败，跳过
 			continue;
 		}
 
@@ -302,14 +304,14 @@ double calculateAccuracy(const ID3& tree, const vector<vector<string>>& testData
 	return total > 0 ? (double)correct / total : 0.0;
 }
 
-// ӡ
-void printConfusionMatrix(const ID3& tree, const vector<vector<string>>& testData, int targetIndex) {
-	if (testData.empty()) return;
+// 打印混淆矩阵
+void printConfusionMatrix(const vector<string>& predictions, const Dataset& testData, int targetIndex) {
+	if (testData.numRows() == 0) return;
 
 	map<string, map<string, int>> confusionMatrix;
-	vector<string> categories = { "", "е", "" };
+	vector<string> categories = { "不及格", "中等", "优秀" };
 
-	// ʼ
+	// 初始化混淆矩阵
 	for (const auto& actual : categories) {
 		for (const auto& predicted : categories) {
 			confusionMatrix[actual][predicted] = 0;
@@ -319,30 +321,69 @@ void printConfusionMatrix(const ID3& tree, const vector<vector<string>>& testDat
 	int totalPredictions = 0;
 	int validPredictions = 0;
 
-	for (const auto& sample : testData) {
+	for (int i = 0; i < testData.numRows(); i++) {
 		totalPredictions++;
-		string actual = sample[targetIndex];
-		string predicted = tree.predict(sample);
+		string actual = testData.valueAt(i, targetIndex);
+		const string& predicted = predictions[i];
 
-		// ֻͳЧԤ
-		if (predicted == "" || predicted == "е" || predicted == "") {
+		// 只统计有效的预测
+		if (predicted == "不及格" || predicted == "中等" || predicted == "优秀") {
 			confusionMatrix[actual][predicted]++;
 			validPredictions++;
 		}
 	}
 
-	cout << "\n      (" << validPredictions << "/" << totalPredictions << "ЧԤ):" << endl;
-	cout << "ʵ\\Ԥ        е    " << endl;
+	cout << "\n     混淆矩阵 (基于" << validPredictions << "/" << totalPredictions << "个有效预测):" << endl;
+	cout << "实际\\预测    不及格    中等    优秀" << endl;
 
 	for (const auto& actual : categories) {
 		cout << actual;
-		if (actual == "") cout << "   ";
-		else if (actual == "е") cout << "     ";
-		else if (actual == "") cout << "     ";
+		if (actual == "不及格") cout << "   ";
+		else if (actual == "中等") cout << "     ";
+		else if (actual == "优秀") cout << "     ";
 
 		for (const auto& predicted : categories) {
 			cout << setw(8) << confusionMatrix[actual][predicted];
 		}
 		cout << endl;
 	}
+}
+
+// 打印交叉验证结果：各折准确率的平均值和标准差，以及所有折累加的混淆矩阵
+void printCrossValidation(const CrossValidationResult& cv, const ValueDictionary& labels) {
+	if (cv.folds.empty()) return;
+
+	cout << fixed << setprecision(2);
+	cout << "     共 " << cv.folds.size() << " 折, 平均准确率: " << cv.meanAccuracy * 100 << "%"
+		<< " (标准差 " << cv.stdAccuracy * 100 << "%)" << endl;
+	if (cv.unknown > 0)
+		cout << "     无法预测的测试样本: " << cv.unknown << endl;
+
+	vector<string> categories = { "不及格", "中等", "优秀" };
+	cout << "\n     混淆矩阵 (所有折累加):" << endl;
+	cout << "实际\\预测    不及格    中等    优秀" << endl;
+	for (const auto& actual : categories) {
+		cout << actual;
+		if (actual == "不及格") cout << "   ";
+		else cout << "     ";
+
+		int actualCode = labels.find(actual);
+		for (const auto& predicted : categories) {
+			int predictedCode = labels.find(predicted);
+			long long count = actualCode < 0 || predictedCode < 0 ? 0 : cv.confusionAt(actualCode, predictedCode);
+			cout << setw(8) << count;
+		}
+		cout << endl;
+	}
+}
+
+// 打印剪枝前后的规模和测试集准确率
+void printPruneStats(const PruneStats& stats, double accuracyBefore, double accuracyAfter) {
+	cout << fixed << setprecision(2);
+	cout << "        节点数: " << stats.nodesBefore << " -> " << stats.nodesAfter
+		<< ", 深度: " << stats.depthBefore << " -> " << stats.depthAfter
+		<< ", 节点数组: " << stats.bytesBefore << " -> " << stats.bytesAfter << " 字节" << endl;
+	cout << "        平均预测路径: " << stats.pathBefore << " -> " << stats.pathAfter << " 个节点"
+		<< ", 剪掉 " << stats.subtreesPruned << " 棵子树" << endl;
+	cout << "        测试集准确率: " << accuracyBefore * 100 << "% -> " << accuracyAfter * 100 << "%" << endl;
 }
\ No newline at end of file
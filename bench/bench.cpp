@@ -0,0 +1,353 @@
+/* 2452214 霍宇哲 大数据 */
+#include "ID3.h"
+#include "CsvReader.h"
+#include "DataGenerator.h"
+#include "DatasetCache.h"
+#include "RandomForest.h"
+#include "MultiTarget.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+/*
+ID3 的性能基准：在一组合成数据集上分别计时
+  加载  loadCsv（内存映射 + 解析 + 字典编码）
+  编码  encodeBatch（把数据集换成模型的编码）
+  训练  ID3::train，重复多次取最小值和中位数
+  预测  ID3::predict 单行延迟（百分位数）、predictBatch 吞吐量
+每个配置输出一行 JSON（JSON Lines），进度信息写到 cerr，便于脚本收集和比较。
+用 ID3_PROFILE 编译时，每行还带有训练的分阶段统计（train_stats）。
+加上 --forest N 时再训练一个 N 棵树的随机森林，计时训练和批量多数表决。
+加上 --out-of-core 时把数据集写成缓存文件，再计时 ID3::trainOutOfCore（逐层扫描文件），并检查树与内存训练的一致。
+加上 --targets N 时把 label 和前 N - 1 个特征列当作 N 个目标，比较逐个训练与 MultiTargetModel（共享根节点扫描、同时训练）的耗时。
+数据由 DataGenerator 按固定种子生成，同样的参数每次得到同样的数据和同样的树。
+
+用法: bench [--rows 10000,100000] [--attrs 8,32] [--cards 4,32] [--classes 2,8]
+            [--threads N] [--repeat N] [--latency-samples N] [--seed N] [--out 文件] [--quick] [--out-of-core] [--forest N]
+            [--targets N]
+*/
+
+struct BenchConfig {
+	int rows;
+	int attrs;       // 特征列数（不含类别列）
+	int cardinality; // 每个特征的取值数
+	int classes;     // 类别数
+};
+
+struct BenchOptions {
+	vector<int> rows;
+	vector<int> attrs;
+	vector<int> cards;
+	vector<int> classes;
+	int threads;
+	int repeat;
+	int latencySamples;
+	unsigned int seed;
+	string outFile;
+	bool outOfCore;
+	int forestTrees;
+	int targets;
+
+	BenchOptions() : rows({ 10000, 100000, 1000000 }), attrs({ 8, 32 }), cards({ 4, 32 }), classes({ 2, 8 }), threads(1),
+		repeat(3), latencySamples(10000), seed(42), outOfCore(false), forestTrees(0), targets(0) {}
+};
+
+const string TEMP_CSV = "bench_tmp.csv";
+const string TEMP_CACHE = "bench_tmp.id3d";
+
+static double secondsSince(chrono::steady_clock::time_point start) {
+	return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// 进程的峰值常驻内存（字节）
+static size_t peakRssBytes() {
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return counters.PeakWorkingSetSize;
+	return 0;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+#ifdef __APPLE__
+	return (size_t)usage.ru_maxrss;
+#else
+	return (size_t)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+// 已排序数组的百分位数
+static double percentile(const vector<double>& sorted, double p) {
+	if (sorted.empty())
+		return 0;
+	size_t index = (size_t)(p / 100.0 * (sorted.size() - 1) + 0.5);
+	return sorted[min(index, sorted.size() - 1)];
+}
+
+static vector<int> parseList(const string& text) {
+	vector<int> values;
+	stringstream ss(text);
+	string item;
+	while (getline(ss, item, ','))
+		if (!item.empty())
+			values.push_back(atoi(item.c_str()));
+	return values;
+}
+
+static void runConfig(const BenchConfig& config, const BenchOptions& options, ostream& out) {
+	cerr << "rows=" << config.rows << " attrs=" << config.attrs << " cardinality=" << config.cardinality
+		<< " classes=" << config.classes << " ..." << endl;
+
+	GeneratorOptions generatorOptions;
+	generatorOptions.rows = config.rows;
+	generatorOptions.attributes = config.attrs;
+	generatorOptions.cardinality = config.cardinality;
+	generatorOptions.classes = config.classes;
+	generatorOptions.seed = options.seed;
+	if (!DataGenerator(generatorOptions).writeCsv(TEMP_CSV))
+		return;
+
+	// 1. 加载
+	auto start = chrono::steady_clock::now();
+	Dataset data;
+	if (!loadCsv(TEMP_CSV, ';', data)) {
+		cerr << "错误: 无法读取 " << TEMP_CSV << endl;
+		return;
+	}
+	double loadSeconds = secondsSince(start);
+	ifstream sizeProbe(TEMP_CSV, ios::binary | ios::ate);
+	double fileBytes = (double)sizeProbe.tellg();
+	sizeProbe.close();
+	remove(TEMP_CSV.c_str());
+
+	// 2. 训练
+	ID3 tree;
+	tree.setThreadCount(options.threads);
+	vector<double> trainSeconds;
+	for (int i = 0; i < max(1, options.repeat); ++i) {
+		start = chrono::steady_clock::now();
+		tree.train(data, "label");
+		trainSeconds.push_back(secondsSince(start));
+	}
+	sort(trainSeconds.begin(), trainSeconds.end());
+
+	// 外存训练：数据从缓存文件逐层扫描
+	vector<double> outOfCoreSeconds;
+	bool outOfCoreSame = false;
+	if (options.outOfCore && saveDatasetCache(data, TEMP_CACHE)) {
+		ID3 diskTree;
+		diskTree.setThreadCount(options.threads);
+		for (int i = 0; i < max(1, options.repeat); ++i) {
+			start = chrono::steady_clock::now();
+			if (!diskTree.trainOutOfCore(TEMP_CACHE, "label"))
+				break;
+			outOfCoreSeconds.push_back(secondsSince(start));
+		}
+		sort(outOfCoreSeconds.begin(), outOfCoreSeconds.end());
+		outOfCoreSame = diskTree.nodeCount() == tree.nodeCount();
+		remove(TEMP_CACHE.c_str());
+	}
+
+	// 3. 编码
+	start = chrono::steady_clock::now();
+	Dataset encoded = tree.encodeBatch(data);
+	double encodeSeconds = secondsSince(start);
+
+	// 4. 单行预测延迟（字符串样本，包含字典查找）
+	int samples = min(options.latencySamples, data.numRows());
+	vector<vector<string>> sampleRows;
+	for (int i = 0; i < samples; ++i)
+		sampleRows.push_back(data.row((int)((long long)i * data.numRows() / samples)));
+	vector<double> latencies;
+	latencies.reserve(samples);
+	size_t checksum = 0; // 防止预测结果被优化掉
+	auto predictStart = chrono::steady_clock::now();
+	for (const vector<string>& row : sampleRows) {
+		auto t = chrono::steady_clock::now();
+		checksum += tree.predict(row).size();
+		latencies.push_back(chrono::duration<double, nano>(chrono::steady_clock::now() - t).count());
+	}
+	double predictSeconds = secondsSince(predictStart);
+	sort(latencies.begin(), latencies.end());
+
+	// 5. 批量预测吞吐量
+	start = chrono::steady_clock::now();
+	vector<int> predictions = tree.predictBatch(encoded);
+	double batchSeconds = secondsSince(start);
+	for (int p : predictions)
+		checksum += (size_t)(p + 1);
+
+	// 6. 随机森林：所有树共享 data，训练和表决都用 options.threads 个线程
+	double forestTrainSeconds = 0, forestBatchSeconds = 0;
+	if (options.forestTrees > 0) {
+		ForestOptions forestOptions;
+		forestOptions.trees = options.forestTrees;
+		forestOptions.threads = options.threads;
+		forestOptions.seed = options.seed;
+		RandomForest forest(forestOptions);
+		start = chrono::steady_clock::now();
+		forest.train(data, "label");
+		forestTrainSeconds = secondsSince(start);
+
+		start = chrono::steady_clock::now();
+		vector<int> votes = forest.predictBatch(encoded);
+		forestBatchSeconds = secondsSince(start);
+		for (int p : votes)
+			checksum += (size_t)(p + 1);
+	}
+
+	// 7. 多目标：逐个训练各目标，再用 MultiTargetModel 一起训练，检查每棵树的节点数相同
+	double singleTargetsSeconds = 0, multiTargetSeconds = 0, rootScanSeconds = 0;
+	bool multiTargetSame = true;
+	int numTargets = min(options.targets, config.attrs + 1);
+	if (numTargets > 0) {
+		vector<string> targets = { "label" };
+		for (int i = 0; i + 1 < numTargets; ++i)
+			targets.push_back("a" + to_string(i));
+		vector<int> nodes;
+		start = chrono::steady_clock::now();
+		for (const string& target : targets) {
+			ID3 single;
+			single.setThreadCount(options.threads);
+			single.train(data, target);
+			nodes.push_back(single.nodeCount());
+		}
+		singleTargetsSeconds = secondsSince(start);
+
+		MultiTargetOptions multiOptions;
+		multiOptions.threads = options.threads;
+		MultiTargetModel multi(multiOptions);
+		start = chrono::steady_clock::now();
+		multi.train(data, targets);
+		multiTargetSeconds = secondsSince(start);
+		rootScanSeconds = multi.rootScanSeconds();
+		for (int t = 0; t < multi.targetCount(); ++t)
+			multiTargetSame = multiTargetSame && multi.tree(t).nodeCount() == nodes[t];
+	}
+
+	out << "{\"rows\":" << config.rows
+		<< ",\"attrs\":" << config.attrs
+		<< ",\"cardinality\":" << config.cardinality
+		<< ",\"classes\":" << config.classes
+		<< ",\"threads\":" << tree.getThreadCount()
+		<< ",\"seed\":" << options.seed
+		<< ",\"csv_bytes\":" << (long long)fileBytes
+		<< ",\"load_s\":" << loadSeconds
+		<< ",\"load_mb_per_s\":" << fileBytes / 1e6 / loadSeconds
+		<< ",\"encode_s\":" << encodeSeconds
+		<< ",\"encode_rows_per_s\":" << config.rows / encodeSeconds
+		<< ",\"train_s_min\":" << trainSeconds.front()
+		<< ",\"train_s_median\":" << trainSeconds[trainSeconds.size() / 2]
+		<< ",\"train_rows_per_s\":" << config.rows / trainSeconds.front()
+		<< ",\"tree_nodes\":" << tree.nodeCount();
+	if (!outOfCoreSeconds.empty())
+		out << ",\"train_ooc_s_min\":" << outOfCoreSeconds.front()
+			<< ",\"train_ooc_s_median\":" << outOfCoreSeconds[outOfCoreSeconds.size() / 2]
+			<< ",\"train_ooc_same_tree\":" << (outOfCoreSame ? "true" : "false");
+	out << ",\"predict_samples\":" << samples
+		<< ",\"predict_rows_per_s\":" << samples / predictSeconds
+		<< ",\"predict_ns_p50\":" << percentile(latencies, 50)
+		<< ",\"predict_ns_p90\":" << percentile(latencies, 90)
+		<< ",\"predict_ns_p99\":" << percentile(latencies, 99)
+		<< ",\"predict_ns_max\":" << (latencies.empty() ? 0 : latencies.back())
+		<< ",\"batch_s\":" << batchSeconds
+		<< ",\"batch_rows_per_s\":" << config.rows / batchSeconds;
+	if (options.forestTrees > 0)
+		out << ",\"forest_trees\":" << options.forestTrees
+			<< ",\"forest_train_s\":" << forestTrainSeconds
+			<< ",\"forest_batch_rows_per_s\":" << config.rows / forestBatchSeconds;
+	if (numTargets > 0)
+		out << ",\"targets\":" << numTargets
+			<< ",\"single_targets_s\":" << singleTargetsSeconds
+			<< ",\"multi_target_s\":" << multiTargetSeconds
+			<< ",\"multi_target_root_scan_s\":" << rootScanSeconds
+			<< ",\"multi_target_same_trees\":" << (multiTargetSame ? "true" : "false");
+	out << ",\"peak_rss_bytes\":" << peakRssBytes()
+		<< ",\"checksum\":" << checksum;
+	// 用 ID3_PROFILE 编译时附上最后一次训练的分阶段统计
+	if (tree.trainStats().enabled)
+		out << ",\"train_stats\":" << tree.trainStats().toJson();
+	out << "}" << endl;
+}
+
+int main(int argc, char* argv[]) {
+	BenchOptions options;
+	for (int i = 1; i < argc; ++i) {
+		string arg = argv[i];
+		string value = i + 1 < argc ? argv[i + 1] : "";
+		if (arg == "--out-of-core") {
+			options.outOfCore = true;
+			continue;
+		}
+		if (arg == "--quick") {
+			options.rows = { 10000 };
+			options.attrs = { 8 };
+			options.cards = { 4 };
+			options.classes = { 2 };
+			options.repeat = 1;
+			continue;
+		}
+		if (value.empty()) {
+			cerr << "错误: 参数 " << arg << " 缺少取值" << endl;
+			return 1;
+		}
+		if (arg == "--rows") options.rows = parseList(value);
+		else if (arg == "--attrs") options.attrs = parseList(value);
+		else if (arg == "--cards") options.cards = parseList(value);
+		else if (arg == "--classes") options.classes = parseList(value);
+		else if (arg == "--threads") options.threads = atoi(value.c_str());
+		else if (arg == "--repeat") options.repeat = atoi(value.c_str());
+		else if (arg == "--latency-samples") options.latencySamples = atoi(value.c_str());
+		else if (arg == "--seed") options.seed = (unsigned int)strtoul(value.c_str(), nullptr, 10);
+		else if (arg == "--out") options.outFile = value;
+		else if (arg == "--forest") options.forestTrees = atoi(value.c_str());
+		else if (arg == "--targets") options.targets = atoi(value.c_str());
+		else {
+			cerr << "错误: 未知参数 " << arg << endl;
+			return 1;
+		}
+		++i;
+	}
+
+	ofstream file;
+	if (!options.outFile.empty()) {
+		file.open(options.outFile);
+		if (!file) {
+			cerr << "错误: 无法写入 " << options.outFile << endl;
+			return 1;
+		}
+	}
+	ostream& out = options.outFile.empty() ? cout : file;
+
+	for (int rows : options.rows)
+		for (int attrs : options.attrs)
+			for (int cardinality : options.cards)
+				for (int classes : options.classes) {
+					if (rows <= 0 || attrs <= 0 || cardinality <= 0 || classes <= 0)
+						continue;
+					BenchConfig config = { rows, attrs, cardinality, classes };
+					runConfig(config, options, out);
+				}
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,182 @@
+/* 2452214 霍宇哲 大数据 */
+#include "PredictionService.h"
+#include "CsvReader.h"
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+
+using namespace std;
+
+/*
+预测服务的压测客户端：读入 CSV 样本，用模型的字典编码后发给 server，统计吞吐和延迟，并用本地加载的同一个模型逐行核对结果。
+  loadgen --model ../ID3实现/student-mat.id3m --data ../ID3实现/student-mat.csv --port 5555 --requests 100000
+  loadgen --model ../ID3实现/student-mat.id3m --data ../ID3实现/student-mat.csv --unix /tmp/id3.sock --connections 16 --depth 8 --rows 4 --shutdown
+--connections 是连接数（每个连接一个线程），--depth 是每个连接上同时在途的请求数，--rows 是每个请求的行数（从样本中随机连续取）。
+延迟从发出请求算到收到响应，包括排队和凑批的时间。
+*/
+
+static void printUsage() {
+	cerr << "用法: loadgen --model 模型.id3m --data 样本.csv [--host 127.0.0.1] [--port N | --unix 路径]" << endl;
+	cerr << "               [--connections N] [--depth N] [--rows N] [--requests N] [--seed N] [--shutdown 1]" << endl;
+}
+
+int main(int argc, char* argv[]) {
+	string modelFile;
+	string dataFile;
+	string host = "127.0.0.1";
+	int port = 5555;
+	string unixPath;
+	int connections = 4;
+	int depth = 4;
+	int rowsPerRequest = 1;
+	long long requests = 100000;
+	unsigned int seed = 42;
+	bool shutdown = false;
+
+	for (int i = 1; i < argc; ++i) {
+		string arg = argv[i];
+		if (i + 1 >= argc) {
+			cerr << "错误: 参数 " << arg << " 缺少取值" << endl;
+			printUsage();
+			return 1;
+		}
+		string value = argv[++i];
+		if (arg == "--model") modelFile = value;
+		else if (arg == "--data") dataFile = value;
+		else if (arg == "--host") host = value;
+		else if (arg == "--port") port = atoi(value.c_str());
+		else if (arg == "--unix") unixPath = value;
+		else if (arg == "--connections") connections = atoi(value.c_str());
+		else if (arg == "--depth") depth = atoi(value.c_str());
+		else if (arg == "--rows") rowsPerRequest = atoi(value.c_str());
+		else if (arg == "--requests") requests = atoll(value.c_str());
+		else if (arg == "--seed") seed = (unsigned int)strtoul(value.c_str(), nullptr, 10);
+		else if (arg == "--shutdown") shutdown = atoi(value.c_str()) != 0;
+		else {
+			cerr << "错误: 未知参数 " << arg << endl;
+			printUsage();
+			return 1;
+		}
+	}
+
+	if (modelFile.empty() || dataFile.empty() || connections < 1 || depth < 1 || rowsPerRequest < 1
+		|| rowsPerRequest > PREDICT_MAX_REQUEST_ROWS || requests < 0) {
+		printUsage();
+		return 1;
+	}
+
+	ID3 model;
+	Dataset data;
+	if (!model.load(modelFile)) {
+		cerr << "错误: 无法加载模型 " << modelFile << endl;
+		return 1;
+	}
+	if (!loadCsv(dataFile, ';', data) || data.numRows() == 0) {
+		cerr << "错误: 无法读取样本 " << dataFile << endl;
+		return 1;
+	}
+
+	// 按模型的列顺序和字典编码成行优先的数组，并在本地算出每行的期望结果
+	Dataset encoded = model.encodeBatch(data);
+	int numRows = encoded.numRows();
+	int numAttrs = encoded.numAttributes();
+	vector<int> codes((size_t)numRows * numAttrs);
+	for (int j = 0; j < numAttrs; ++j) {
+		const vector<int>& column = encoded.column(j);
+		for (int r = 0; r < numRows; ++r)
+			codes[(size_t)r * numAttrs + j] = column[r];
+	}
+	vector<int> expected(numRows);
+	model.predictBatch(codes.data(), numRows, expected.data());
+
+	LatencyRecorder latency;
+	atomic<long long> mismatches(0);
+	atomic<long long> completed(0);
+	atomic<bool> failed(false);
+
+	auto worker = [&](int index) {
+		PredictionClient client;
+		if (!(unixPath.empty() ? client.connectTcp(host, port) : client.connectUnix(unixPath))) {
+			cerr << "错误: 无法连接到预测服务" << endl;
+			failed = true;
+			return;
+		}
+
+		long long quota = requests / connections + (index < requests % connections ? 1 : 0);
+		SplitMix64 rng(seed * 1000003ULL + index);
+		vector<int> request((size_t)rowsPerRequest * numAttrs);
+		map<unsigned int, pair<chrono::steady_clock::time_point, int>> inFlight;  // 请求号 -> (发出时间, 首行)
+		vector<int> labels;
+		long long sent = 0;
+
+		while (sent < quota || !inFlight.empty()) {
+			while (sent < quota && (int)inFlight.size() < depth) {
+				int first = rng.below(numRows);
+				for (int k = 0; k < rowsPerRequest; ++k) {
+					int r = (first + k) % numRows;
+					copy(codes.begin() + (size_t)r * numAttrs, codes.begin() + (size_t)(r + 1) * numAttrs, request.begin() + (size_t)k * numAttrs);
+				}
+				auto now = chrono::steady_clock::now();
+				unsigned int id = client.sendPredict(request.data(), rowsPerRequest, numAttrs);
+				if (id == 0) {
+					failed = true;
+					return;
+				}
+				inFlight[id] = make_pair(now, first);
+				++sent;
+			}
+
+			unsigned int id;
+			if (!client.receivePredict(id, labels)) {
+				failed = true;
+				return;
+			}
+			auto it = inFlight.find(id);
+			if (it == inFlight.end() || (int)labels.size() != rowsPerRequest) {
+				cerr << "错误: 收到未知的响应 " << id << endl;
+				failed = true;
+				return;
+			}
+			latency.add(chrono::duration<double>(chrono::steady_clock::now() - it->second.first).count());
+			for (int k = 0; k < rowsPerRequest; ++k)
+				if (labels[k] != expected[(it->second.second + k) % numRows])
+					++mismatches;
+			inFlight.erase(it);
+			++completed;
+		}
+	};
+
+	auto start = chrono::steady_clock::now();
+	vector<thread> threads;
+	for (int c = 0; c < connections; ++c)
+		threads.emplace_back(worker, c);
+	for (thread& t : threads)
+		t.join();
+	double seconds = max(chrono::duration<double>(chrono::steady_clock::now() - start).count(), 1e-9);
+
+	LatencySummary summary = latency.summary();
+	cout << "请求 " << completed << " 个 (每个 " << rowsPerRequest << " 行), " << connections << " 个连接, 每个连接在途 "
+		<< depth << " 个" << endl;
+	cout << "用时 " << seconds << " 秒, QPS " << (long long)(completed / seconds) << ", 行/秒 "
+		<< (long long)(completed * rowsPerRequest / seconds) << endl;
+	cout << "延迟 p50 " << (long long)(summary.p50 * 1e6) << " us, p99 " << (long long)(summary.p99 * 1e6)
+		<< " us, 最大 " << (long long)(summary.max * 1e6) << " us" << endl;
+	cout << "与本地模型结果不一致: " << mismatches << " 行" << endl;
+
+	PredictionClient control;
+	if (unixPath.empty() ? control.connectTcp(host, port) : control.connectUnix(unixPath)) {
+		string stats;
+		if (control.serverStats(stats))
+			cout << "服务端统计: " << stats << endl;
+		if (shutdown && !control.shutdownServer())
+			cerr << "错误: 无法关闭预测服务" << endl;
+	}
+
+	return failed || mismatches > 0 ? 1 : 0;
+}
\ No newline at end of file
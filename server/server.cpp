@@ -0,0 +1,68 @@
+/* 2452214 霍宇哲 大数据 */
+#include "PredictionService.h"
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+using namespace std;
+
+/*
+本机预测服务：加载训练好的模型（运行 ID3实现 后保存的 student-mat.id3m），通过 TCP 回环或 Unix 域套接字提供批量预测。
+  server --model ../ID3实现/student-mat.id3m --port 5555
+  server --model ../ID3实现/student-mat.id3m --unix /tmp/id3.sock --batch-rows 512 --max-delay-us 100
+同时到达的请求被拼成微批一起预测，--max-delay-us 是一个请求为凑批最多等待的时间，协议见 PredictionService.h。
+运行期间定期打印吞吐和 p50 / p99 延迟；收到 SHUTDOWN 请求（loadgen --shutdown）后打印累计统计并退出。
+*/
+
+static void printUsage() {
+	cerr << "用法: server --model 模型.id3m [--port N | --unix 路径] [--batch-rows N] [--max-delay-us N]" << endl;
+	cerr << "              [--stats-interval 秒]" << endl;
+}
+
+int main(int argc, char* argv[]) {
+	ServerOptions options;
+	string modelFile;
+
+	for (int i = 1; i < argc; ++i) {
+		string arg = argv[i];
+		if (i + 1 >= argc) {
+			cerr << "错误: 参数 " << arg << " 缺少取值" << endl;
+			printUsage();
+			return 1;
+		}
+		string value = argv[++i];
+		if (arg == "--model") modelFile = value;
+		else if (arg == "--port") options.port = atoi(value.c_str());
+		else if (arg == "--unix") options.unixPath = value;
+		else if (arg == "--batch-rows") options.batchRows = atoi(value.c_str());
+		else if (arg == "--max-delay-us") options.maxDelayMicros = atoi(value.c_str());
+		else if (arg == "--stats-interval") options.statsIntervalSeconds = atoi(value.c_str());
+		else {
+			cerr << "错误: 未知参数 " << arg << endl;
+			printUsage();
+			return 1;
+		}
+	}
+
+	if (modelFile.empty()) {
+		printUsage();
+		return 1;
+	}
+
+	ID3 model;
+	if (!model.load(modelFile)) {
+		cerr << "错误: 无法加载模型 " << modelFile << endl;
+		return 1;
+	}
+
+	PredictionServer server(model, options);
+	if (!server.start())
+		return 1;
+	cerr << "预测服务已启动: " << (options.unixPath.empty() ? "127.0.0.1:" + to_string(server.port()) : options.unixPath)
+		<< ", 每批最多 " << options.batchRows << " 行, 最多等待 " << options.maxDelayMicros << " us" << endl;
+
+	server.wait();
+	server.stop();
+	cout << server.statsJson() << endl;
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,180 @@
+/* 2452214 霍宇哲 大数据 */
+#include "DatasetCache.h"
+#include "CsvReader.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+
+/*
+检查数据集缓存文件（DatasetCache.h）的读写：
+  1. saveDatasetCache 写出、loadDatasetCache 读回的数据集与原数据集逐格相同（列名、字典、编码）
+  2. DatasetCacheWriter 按行块分段写出的文件与一次写出的完全相同；DatasetCacheReader 分段读出的编码与原数据相同
+  3. 截断的文件、文件头和列目录被改坏的文件（重复的字典取值、超大的列数 / 行数 / 偏移等）都被拒绝；
+     逐个字节改坏文件头和列目录时不崩溃，读出的行数和列数与文件的大小相符
+用法: cache_test [csv 文件]
+*/
+
+const string CACHE_FILE = "cache_test.id3d";
+const int CHUNK_ROWS = 37;
+
+int failures = 0;
+
+void check(bool ok, const string& what) {
+    if (!ok) {
+        cerr << "失败: " << what << endl;
+        failures++;
+    }
+}
+
+string readFile(const string& filename) {
+    ifstream in(filename, ios::binary);
+    stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+void writeFile(const string& filename, const string& content) {
+    ofstream out(filename, ios::binary | ios::trunc);
+    out << content;
+}
+
+void putU32(string& s, size_t offset, unsigned int value) {
+    memcpy(&s[offset], &value, 4);
+}
+
+void putU64(string& s, size_t offset, unsigned long long value) {
+    memcpy(&s[offset], &value, 8);
+}
+
+bool sameDataset(const Dataset& a, const Dataset& b) {
+    if (a.attributeNames() != b.attributeNames() || a.numRows() != b.numRows())
+        return false;
+    for (int j = 0; j < a.numAttributes(); j++) {
+        if (a.dictionary(j).allValues() != b.dictionary(j).allValues() || a.column(j) != b.column(j))
+            return false;
+    }
+    return true;
+}
+
+// 两种读法都必须拒绝 content
+void expectRejected(const string& content, const string& what) {
+    writeFile(CACHE_FILE, content);
+    Dataset loaded;
+    check(!loadDatasetCache(CACHE_FILE, loaded), "loadDatasetCache 接受了" + what);
+    DatasetCacheReader reader;
+    check(!reader.open(CACHE_FILE), "DatasetCacheReader 接受了" + what);
+}
+
+int main(int argc, char* argv[]) {
+    string csvFile = argc > 1 ? argv[1] : "../ID3实现/student-mat.csv";
+    Dataset data;
+    if (!loadCsv(csvFile, ';', data) || data.numRows() == 0) {
+        cerr << "无法读取数据文件: " << csvFile << endl;
+        return 1;
+    }
+    const int numAttrs = data.numAttributes();
+
+    // 1. 整体写出再读回
+    check(saveDatasetCache(data, CACHE_FILE), "saveDatasetCache 失败");
+    const string original = readFile(CACHE_FILE);
+    Dataset loaded;
+    check(loadDatasetCache(CACHE_FILE, loaded) && sameDataset(data, loaded), "loadDatasetCache 读回的数据集与原数据集不同");
+    check(isDatasetCacheFresh(CACHE_FILE, csvFile), "刚写出的缓存被认为已过期");
+    check(!isDatasetCacheFresh(CACHE_FILE + ".missing", csvFile), "不存在的缓存被认为有效");
+
+    // 2. 分段写出、分段读出
+    vector<ValueDictionary> dicts;
+    for (int j = 0; j < numAttrs; j++)
+        dicts.push_back(data.dictionary(j));
+    DatasetCacheWriter writer;
+    bool written = writer.open(CACHE_FILE, data.attributeNames(), dicts, data.numRows());
+    for (int j = numAttrs - 1; j >= 0; j--) {
+        for (int first = 0; first < data.numRows(); first += CHUNK_ROWS) {
+            int count = min(CHUNK_ROWS, data.numRows() - first);
+            written = writer.writeRows(j, first, data.column(j).data() + first, count) && written;
+        }
+    }
+    written = writer.close() && written;
+    check(written && readFile(CACHE_FILE) == original, "DatasetCacheWriter 分段写出的文件与 saveDatasetCache 不同");
+
+    DatasetCacheReader reader;
+    if (reader.open(CACHE_FILE)) {
+        check(reader.attributeNames() == data.attributeNames() && reader.numRows() == data.numRows(), "DatasetCacheReader 的列名或行数不同");
+        vector<vector<int>> columns;
+        for (int first = 0; first < data.numRows(); first += CHUNK_ROWS) {
+            int count = min(CHUNK_ROWS, data.numRows() - first);
+            bool same = reader.readRows(first, count, columns);
+            for (int j = 0; j < numAttrs && same; j++)
+                same = equal(columns[j].begin(), columns[j].begin() + count, data.column(j).begin() + first);
+            check(same, "DatasetCacheReader 读出的第 " + to_string(first) + " 行起的编码不同");
+        }
+        reader.close();
+    }
+    else {
+        check(false, "DatasetCacheReader 打不开正常的缓存文件");
+    }
+
+    // 3. 损坏的文件
+    for (size_t length = 0; length < original.size(); length += 1 + length / 8)
+        expectRejected(original.substr(0, length), "截断到 " + to_string(length) + " 字节的文件");
+    expectRejected(original.substr(0, original.size() - 1), "少了最后一个字节的文件");
+
+    string bad = original;
+    bad[0] = 'X';
+    expectRejected(bad, "魔数错误的文件");
+    bad = original;
+    putU32(bad, 4, DATASET_CACHE_VERSION + 1);
+    expectRejected(bad, "版本不符的文件");
+    bad = original;
+    putU32(bad, 8, 0xFFFFFFF0u);
+    expectRejected(bad, "列数超过文件大小的文件");
+    bad = original;
+    putU32(bad, 12, 0x90000000u);
+    expectRejected(bad, "行数超过 INT_MAX 的文件");
+    bad = original;
+    putU64(bad, 16 + 8, ~0ULL - 10);
+    expectRejected(bad, "数据偏移接近 2^64 的文件");
+    bad = original;
+    putU32(bad, 16 + 20, 3);
+    expectRejected(bad, "编码宽度为 3 的文件");
+
+    // 把第 0 列字典的第二个取值改成第一个：字典按编码顺序写出，重复的取值会让后面的编码整体错位
+    {
+        const ValueDictionary& dict = data.dictionary(0);
+        const string name = data.attributeNames()[0];
+        size_t first = 16 + 24 * (size_t)numAttrs + 4 + name.size();
+        if (dict.size() >= 2 && dict.value(0).size() == dict.value(1).size()) {
+            bad = original;
+            size_t second = first + 4 + dict.value(0).size();
+            bad.replace(second + 4, dict.value(1).size(), dict.value(0));
+            expectRejected(bad, "字典里有重复取值的文件");
+        }
+    }
+
+    // 逐个字节改坏文件头和列目录：可以接受或拒绝，但不能崩溃，接受时的规模必须与文件相符
+    const size_t directoryEnd = 16 + 24 * (size_t)numAttrs;
+    for (size_t i = 0; i < directoryEnd; i++) {
+        bad = original;
+        bad[i] = (char)(bad[i] ^ 0xA5);
+        writeFile(CACHE_FILE, bad);
+        Dataset corrupted;
+        if (loadDatasetCache(CACHE_FILE, corrupted)) {
+            check((size_t)corrupted.numRows() <= bad.size() && (size_t)corrupted.numAttributes() <= bad.size(),
+                "改坏第 " + to_string(i) + " 字节后读出了超过文件大小的数据集");
+        }
+    }
+
+    remove(CACHE_FILE.c_str());
+    if (failures > 0) {
+        cout << "测试失败，" << failures << " 处错误" << endl;
+        return 1;
+    }
+    cout << "测试通过" << endl;
+    return 0;
+}
\ No newline at end of file
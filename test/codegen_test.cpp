@@ -0,0 +1,112 @@
+/* 2452214 霍宇哲 大数据 */
+#include "ID3.h"
+#include "CsvReader.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+
+// 由 ID3::exportCpp 生成的预测函数，模型或导出格式改变后用 --regenerate 重新生成
+#include "student_mat_predictor.inc"
+
+using namespace std;
+
+/*
+检查 ID3::exportCpp 导出的预测函数与 ID3::predict / predictCode 的结果完全一致。
+在完整的 student-mat.csv 上训练（目标为原始的 G3 成绩），然后：
+  1. 重新导出代码，与编译进来的 student_mat_predictor.inc 比较，确认它没有过期
+  2. 对每一行比较生成的函数和 predictCode 返回的类别编码，以及类别字符串和 predict 的结果
+  3. 把每一行的每个属性依次改成训练时没见过的编码，比较两者都返回 -1 的情况
+用法: codegen_test [csv 文件] [--regenerate]
+*/
+
+const string GENERATED_FILE = "student_mat_predictor.inc";
+const string FUNCTION_NAME = "predictStudentMat";
+
+string readFile(const string& filename) {
+    ifstream in(filename, ios::binary);
+    stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+int main(int argc, char* argv[]) {
+    string csvFile = "../ID3实现/student-mat.csv";
+    bool regenerate = false;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--regenerate")
+            regenerate = true;
+        else
+            csvFile = arg;
+    }
+
+    Dataset data;
+    if (!loadCsv(csvFile, ';', data) || data.numRows() == 0) {
+        cerr << "无法读取数据文件: " << csvFile << endl;
+        return 1;
+    }
+
+    ID3 tree;
+    tree.train(data, "G3");
+
+    // 1. 生成的代码是否过期
+    ostringstream generated;
+    tree.exportCpp(generated, FUNCTION_NAME);
+    if (regenerate) {
+        if (!tree.exportCpp(GENERATED_FILE, FUNCTION_NAME))
+            return 1;
+        cout << "已重新生成 " << GENERATED_FILE << "，请重新编译后再运行测试" << endl;
+        return 0;
+    }
+    if (generated.str() != readFile(GENERATED_FILE)) {
+        cerr << "失败: " << GENERATED_FILE << " 已过期，请用 --regenerate 重新生成" << endl;
+        return 1;
+    }
+
+    // 2. 逐行比较
+    Dataset encoded = tree.encodeBatch(data);
+    const int numAttrs = encoded.numAttributes();
+    vector<int> codes(numAttrs);
+    int failures = 0;
+    int unseenChecks = 0;
+
+    for (int r = 0; r < encoded.numRows(); r++) {
+        for (int j = 0; j < numAttrs; j++)
+            codes[j] = encoded.code(r, j);
+
+        int expected = tree.predictCode(codes.data());
+        int actual = predictStudentMat(codes.data());
+        if (actual != expected) {
+            cerr << "第 " << r << " 行: predictCode = " << expected << "，生成的函数 = " << actual << endl;
+            failures++;
+            continue;
+        }
+        if (actual >= 0 && tree.predict(data.row(r)) != predictStudentMat_labels[actual]) {
+            cerr << "第 " << r << " 行: predict = " << tree.predict(data.row(r))
+                 << "，生成的函数 = " << predictStudentMat_labels[actual] << endl;
+            failures++;
+        }
+
+        // 3. 训练时没见过的取值
+        for (int j = 0; j < numAttrs; j++) {
+            int saved = codes[j];
+            codes[j] = -1;
+            if (predictStudentMat(codes.data()) != tree.predictCode(codes.data())) {
+                cerr << "第 " << r << " 行第 " << j << " 列为未知取值时结果不一致" << endl;
+                failures++;
+            }
+            codes[j] = saved;
+            unseenChecks++;
+        }
+    }
+
+    cout << "比较了 " << encoded.numRows() << " 行，" << unseenChecks << " 次未知取值，失败 " << failures << " 次" << endl;
+    if (failures > 0) {
+        cout << "测试失败" << endl;
+        return 1;
+    }
+    cout << "测试通过" << endl;
+    return 0;
+}
@@ -0,0 +1,110 @@
+/* 2452214 霍宇哲 大数据 */
+#include "ID3.h"
+#include "CsvReader.h"
+#include "CrossValidation.h"
+#include <iostream>
+#include <vector>
+#include <string>
+
+using namespace std;
+
+/*
+检查 crossValidate（所有折共享一个数据集，按行号列表训练和预测）与最直接的做法结果相同：
+对每一折用 Dataset::select 复制出训练集和测试集，在训练集上训练，测试集经 encodeBatch 编码后预测。
+  1. 逐行比较 trainOnRows + predictRow 与 select 做法的预测（都按类别字符串比较，两边的编码不同）
+  2. 比较 crossValidate 每一折的 predicted / correct 和累加的混淆矩阵
+分类属性和数值属性（age、absences、G1、G2）各做一遍，测试折里常有训练折没见过的取值。
+用法: cv_test [csv 文件]
+*/
+
+const int FOLDS = 5;
+const int REPEATS = 2;
+
+int failures = 0;
+
+void check(bool ok, const string& what) {
+    if (!ok) {
+        cerr << "失败: " << what << endl;
+        failures++;
+    }
+}
+
+void runCase(const Dataset& data, const string& target, const vector<string>& numeric, const string& name) {
+    CrossValidationOptions options;
+    options.folds = FOLDS;
+    options.repeats = REPEATS;
+    options.threads = 2;
+    auto configure = [&](ID3& tree) { tree.setNumericAttributes(numeric); };
+    CrossValidationResult cv = crossValidate(data, target, options, configure);
+
+    const int targetIndex = data.findAttribute(target);
+    const ValueDictionary& labels = data.dictionary(targetIndex);
+    const int numClasses = labels.size();
+    vector<long long> confusion((size_t)numClasses * numClasses, 0);
+    int rows = 0, unseen = 0;
+
+    for (int repeat = 0; repeat < REPEATS; repeat++) {
+        vector<int> foldOf = assignFolds(data, targetIndex, options, repeat);
+        for (int fold = 0; fold < FOLDS; fold++) {
+            vector<int> trainRows, testRows;
+            for (int r = 0; r < data.numRows(); r++)
+                (foldOf[r] == fold ? testRows : trainRows).push_back(r);
+
+            // 共享数据集的做法
+            ID3 shared;
+            configure(shared);
+            shared.trainOnRows(data, target, trainRows);
+
+            // 复制子集的做法
+            Dataset trainSet = data.select(trainRows);
+            Dataset testSet = data.select(testRows);
+            ID3 copied;
+            configure(copied);
+            copied.train(trainSet, target);
+            vector<int> predictions = copied.predictBatch(copied.encodeBatch(testSet));
+
+            int predicted = 0, correct = 0;
+            for (size_t i = 0; i < testRows.size(); i++) {
+                const int r = testRows[i];
+                const int label = shared.predictRow(data, r);
+                const string expected = predictions[i] < 0 ? "" : copied.labelDictionary().value(predictions[i]);
+                const string actual = label < 0 ? "" : labels.value(label);
+                check(actual == expected, name + " 第 " + to_string(repeat) + " 次第 " + to_string(fold) + " 折第 " + to_string(r)
+                    + " 行: trainOnRows 预测 \"" + actual + "\"，select 预测 \"" + expected + "\"");
+                rows++;
+                if (label < 0) {
+                    unseen++;
+                    continue;
+                }
+                predicted++;
+                correct += label == data.code(r, targetIndex);
+                confusion[(size_t)data.code(r, targetIndex) * numClasses + label]++;
+            }
+
+            const FoldResult& result = cv.folds[repeat * FOLDS + fold];
+            check(result.predicted == predicted && result.correct == correct,
+                name + " 第 " + to_string(repeat) + " 次第 " + to_string(fold) + " 折的 predicted / correct 不一致");
+        }
+    }
+    check(cv.confusion == confusion, name + " 混淆矩阵不一致");
+    cout << name << ": 比较了 " << rows << " 行，其中 " << unseen << " 行遇到没见过的取值" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    string csvFile = argc > 1 ? argv[1] : "../ID3实现/student-mat.csv";
+    Dataset data;
+    if (!loadCsv(csvFile, ';', data) || data.numRows() == 0) {
+        cerr << "无法读取数据文件: " << csvFile << endl;
+        return 1;
+    }
+
+    runCase(data, "G3", {}, "分类属性");
+    runCase(data, "G3", { "age", "absences", "G1", "G2" }, "数值属性");
+
+    if (failures > 0) {
+        cout << "测试失败，" << failures << " 处不一致" << endl;
+        return 1;
+    }
+    cout << "测试通过" << endl;
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,185 @@
+/* 2452214 霍宇哲 大数据 */
+#include "Discretizer.h"
+#include "CsvReader.h"
+#include <iostream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+/*
+检查离散化（Discretizer / QuantileSketch）：
+  1. 在 student-mat 的数值列上 fit 后，精确分位数和等宽分箱的切点与按排序后的取值直接算出的相同
+  2. transform（每个取值解析一次、逐行查表）得到的每一行与逐个取值调用 binLabel 的结果相同，
+     不是数字的取值归入 missingLabel；用 setCuts 指定的箱名与 main 中 G3 的分级一致
+  3. 取值很多的列改用草图：切点的秩与精确分位数相差不超过 1%；QuantileSketch 合并后与一次喂入的结果接近
+用法: discretizer_test [csv 文件]
+*/
+
+const vector<string> NUMERIC = { "age", "absences", "G1", "G2" };
+const int BINS = 4;
+
+int failures = 0;
+
+void check(bool ok, const string& what) {
+    if (!ok) {
+        cerr << "失败: " << what << endl;
+        failures++;
+    }
+}
+
+// 列中所有数字取值，升序
+vector<double> sortedNumbers(const Dataset& data, int col) {
+    vector<double> numbers;
+    for (int r = 0; r < data.numRows(); r++) {
+        double number;
+        if (parseNumber(data.valueAt(r, col), number))
+            numbers.push_back(number);
+    }
+    sort(numbers.begin(), numbers.end());
+    return numbers;
+}
+
+// 去重，并去掉不小于最大值的切点
+vector<double> trimmed(vector<double> cuts, double maxValue) {
+    sort(cuts.begin(), cuts.end());
+    cuts.erase(unique(cuts.begin(), cuts.end()), cuts.end());
+    while (!cuts.empty() && cuts.back() >= maxValue)
+        cuts.pop_back();
+    return cuts;
+}
+
+// 第 i 个切点是第一个使累计行数达到 i / bins 的取值
+vector<double> expectedQuantileCuts(const vector<double>& numbers, int bins) {
+    vector<double> cuts;
+    for (int i = 1; i < bins; i++) {
+        const double target = (double)numbers.size() * i / bins;
+        size_t k = 0;
+        while ((double)(k + 1) < target)
+            k++;
+        cuts.push_back(numbers[k]);
+    }
+    return trimmed(cuts, numbers.back());
+}
+
+vector<double> expectedEqualWidthCuts(const vector<double>& numbers, int bins) {
+    vector<double> cuts;
+    for (int i = 1; i < bins; i++)
+        cuts.push_back(numbers.front() + (numbers.back() - numbers.front()) * i / bins);
+    return trimmed(cuts, numbers.back());
+}
+
+// transform 后的每一行都等于 binLabel(原来的取值)
+void checkTransform(const Discretizer& discretizer, const Dataset& original, const vector<string>& columns, const string& name) {
+    Dataset binned = original;
+    discretizer.transform(binned);
+    check(binned.numRows() == original.numRows(), name + ": transform 改变了行数");
+    for (const string& column : columns) {
+        const int col = original.findAttribute(column);
+        for (int r = 0; r < original.numRows(); r++) {
+            if (binned.valueAt(r, col) != discretizer.binLabel(column, original.valueAt(r, col))) {
+                check(false, name + ": 列 " + column + " 第 " + to_string(r) + " 行的箱与 binLabel 不同");
+                break;
+            }
+        }
+        const ValueDictionary& dict = binned.dictionary(col);
+        check(is_sorted(dict.allValues().begin(), dict.allValues().end()), name + ": 列 " + column + " 的箱名没有按字典序编码");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    string csvFile = argc > 1 ? argv[1] : "../ID3实现/student-mat.csv";
+    Dataset data;
+    if (!loadCsv(csvFile, ';', data) || data.numRows() == 0) {
+        cerr << "无法读取数据文件: " << csvFile << endl;
+        return 1;
+    }
+
+    // 1. 切点
+    BinningOptions quantileOptions;
+    quantileOptions.bins = BINS;
+    Discretizer quantile(quantileOptions);
+    check(quantile.fit(data, NUMERIC), "分位数 fit 失败");
+    BinningOptions widthOptions;
+    widthOptions.method = BINNING_EQUAL_WIDTH;
+    widthOptions.bins = BINS;
+    Discretizer width(widthOptions);
+    check(width.fit(data, NUMERIC), "等宽 fit 失败");
+    for (const string& column : NUMERIC) {
+        const vector<double> numbers = sortedNumbers(data, data.findAttribute(column));
+        check(quantile.cuts(column) == expectedQuantileCuts(numbers, BINS), "列 " + column + " 的分位数切点不对");
+        check(width.cuts(column) == expectedEqualWidthCuts(numbers, BINS), "列 " + column + " 的等宽切点不对");
+    }
+    check(!quantile.fit(data, { "no such column" }), "不存在的列 fit 没有返回 false");
+    check(!quantile.fit(data, { "school" }), "没有数字的列 fit 没有返回 false");
+
+    // 2. transform 与 binLabel；部分取值改成不是数字
+    Dataset withMissing(data.attributeNames());
+    for (int r = 0; r < data.numRows(); r++) {
+        vector<string> row = data.row(r);
+        if (r % 11 == 0)
+            row[data.findAttribute("absences")] = r % 2 ? "NA" : "";
+        withMissing.appendRow(row);
+    }
+    withMissing.sortDictionaries();
+    checkTransform(quantile, withMissing, NUMERIC, "分位数");
+    checkTransform(width, withMissing, NUMERIC, "等宽");
+    check(quantile.binLabel("absences", "NA") == quantileOptions.missingLabel, "不是数字的取值没有归入 missingLabel");
+
+    Discretizer grades;
+    grades.setCuts("G3", { 9.5, 14.5 }, { "不及格", "中等", "优秀" });
+    checkTransform(grades, data, { "G3" }, "G3 分级");
+    for (int grade = 0; grade <= 20; grade++) {
+        const string expected = grade < 10 ? "不及格" : grade < 15 ? "中等" : "优秀";
+        check(grades.binLabel("G3", to_string(grade)) == expected, "成绩 " + to_string(grade) + " 的分级不对");
+    }
+
+    // 3. 取值很多的列走草图
+    const int rows = DISCRETIZE_EXACT_VALUES * 3;
+    Dataset continuous({ "x" });
+    vector<double> values;
+    unsigned int state = 7;
+    for (int r = 0; r < rows; r++) {
+        state = state * 1103515245u + 12345u;
+        const double x = (double)(state >> 4) / 1000.0;
+        values.push_back(x);
+        continuous.appendRow({ to_string(x) });
+    }
+    continuous.sortDictionaries();
+    check(continuous.dictionary(0).size() > DISCRETIZE_EXACT_VALUES, "生成的列取值不够多，没有走草图");
+
+    Discretizer sketched(quantileOptions);
+    check(sketched.fit(continuous, { "x" }), "草图 fit 失败");
+    const vector<double> exact = sortedNumbers(continuous, 0);
+    const vector<double>& cuts = sketched.cuts("x");
+    check((int)cuts.size() == BINS - 1, "草图的切点数不对");
+    for (size_t i = 0; i < cuts.size(); i++) {
+        const double rank = (double)(upper_bound(exact.begin(), exact.end(), cuts[i]) - exact.begin()) / rows;
+        check(fabs(rank - (double)(i + 1) / BINS) <= 0.01, "草图的第 " + to_string(i) + " 个切点误差超过 1%");
+    }
+    checkTransform(sketched, continuous, { "x" }, "草图");
+
+    QuantileSketch whole, left, right;
+    for (int r = 0; r < rows; r++) {
+        whole.add(values[r]);
+        (r % 2 ? left : right).add(values[r]);
+    }
+    left.merge(right);
+    check(left.totalWeight() == whole.totalWeight(), "合并后的总权重不对");
+    check(whole.quantile(1.0) == exact.back() && left.quantile(1.0) == exact.back(), "草图的最大值不精确");
+    for (double q = 0.05; q < 1.0; q += 0.05) {
+        const double a = (double)(upper_bound(exact.begin(), exact.end(), whole.quantile(q)) - exact.begin()) / rows;
+        const double b = (double)(upper_bound(exact.begin(), exact.end(), left.quantile(q)) - exact.begin()) / rows;
+        check(fabs(a - q) <= 0.01 && fabs(b - q) <= 0.01, "分位数 " + to_string(q) + " 的秩误差超过 1%");
+    }
+    cout << "草图: " << rows << " 行，切点 " << cuts.size() << " 个" << endl;
+
+    if (failures > 0) {
+        cout << "测试失败，" << failures << " 处错误" << endl;
+        return 1;
+    }
+    cout << "测试通过" << endl;
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+/* 2452214 霍宇哲 大数据 */
+#include "ID3.h"
+#include "CsvReader.h"
+#include "DataGenerator.h"
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <string>
+
+using namespace std;
+
+/*
+检查增量训练（ID3::setIncremental / ID3::update）：每吸收一批新行后，模型与在 trainingData() 上重新训练的树完全相同
+（比较 exportCpp 导出的代码，它包含树的全部节点、阈值和字典）。
+  1. 生成的数据：批的大小逐渐变大，覆盖只改叶子、重建子树、整理 Arena 的情况；串行和多线程各一遍
+  2. student-mat：分批吸收，新批里常有没见过的取值（字典扩充后重新训练），分类属性和数值属性各一遍
+  3. 随机抽取候选属性时 update 返回 false
+用法: incremental_test [csv 文件]
+*/
+
+int failures = 0;
+
+void check(bool ok, const string& what) {
+    if (!ok) {
+        cerr << "失败: " << what << endl;
+        failures++;
+    }
+}
+
+string exported(const ID3& tree) {
+    ostringstream out;
+    tree.exportCpp(out, "f");
+    return out.str();
+}
+
+// data 的 [begin, end) 行，作为一个独立编码的数据集（与新到的数据一样，字典与模型无关）
+Dataset slice(const Dataset& data, int begin, int end) {
+    Dataset out(data.attributeNames());
+    for (int r = begin; r < end; r++)
+        out.appendRow(data.row(r));
+    out.sortDictionaries();
+    return out;
+}
+
+// 先用前 first 行训练，之后每批比上一批多 growth 行地吸收剩下的行，每批之后与重新训练比较
+void runCase(const Dataset& data, const string& target, const vector<string>& numeric, int threads,
+    int first, int growth, const string& name) {
+    ID3 incremental;
+    incremental.setIncremental(true);
+    incremental.setThreadCount(threads);
+    incremental.setNumericAttributes(numeric);
+    incremental.train(slice(data, 0, first), target);
+
+    int batches = 0;
+    int step = 1;
+    for (int begin = first; begin < data.numRows(); ) {
+        int end = min(data.numRows(), begin + step);
+        step += growth;
+        if (!incremental.update(slice(data, begin, end))) {
+            check(false, name + ": update 失败");
+            return;
+        }
+        begin = end;
+        batches++;
+
+        ID3 retrained;
+        retrained.setNumericAttributes(numeric);
+        retrained.train(incremental.trainingData(), target);
+        if (exported(incremental) != exported(retrained)) {
+            check(false, name + ": 吸收到第 " + to_string(end) + " 行时与重新训练的树不同");
+            return;
+        }
+    }
+    check(incremental.trainingData().numRows() == data.numRows(), name + ": trainingData 的行数不对");
+    cout << name << ": " << batches << " 批，" << incremental.nodeCount() << " 个节点" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    string csvFile = argc > 1 ? argv[1] : "../ID3实现/student-mat.csv";
+    Dataset data;
+    if (!loadCsv(csvFile, ';', data) || data.numRows() == 0) {
+        cerr << "无法读取数据文件: " << csvFile << endl;
+        return 1;
+    }
+
+    // 1. 生成的数据
+    for (unsigned int seed = 1; seed <= 3; seed++) {
+        GeneratorOptions options;
+        options.rows = 4000;
+        options.attributes = 8;
+        options.cardinality = 3 + seed;
+        options.classes = 3;
+        options.labelNoise = 0.2;
+        options.seed = seed;
+        Dataset generated = DataGenerator(options).generate();
+        runCase(generated, "label", {}, seed == 1 ? 1 : 2, 50, 8, "生成的数据 seed " + to_string(seed));
+    }
+
+    // 2. student-mat
+    runCase(data, "G3", {}, 1, 100, 4, "student-mat 分类属性");
+    runCase(data, "G3", { "age", "absences", "G1", "G2" }, 1, 100, 4, "student-mat 数值属性");
+
+    // 3. 随机抽取候选属性的模型不能增量更新
+    ID3 subset;
+    subset.setIncremental(true);
+    subset.setFeatureSubset(3, 1);
+    subset.train(slice(data, 0, 100), "G3");
+    check(!subset.update(slice(data, 100, 120)), "随机抽取候选属性时 update 没有返回 false");
+
+    if (failures > 0) {
+        cout << "测试失败，" << failures << " 处错误" << endl;
+        return 1;
+    }
+    cout << "测试通过" << endl;
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,189 @@
+/* 2452214 霍宇哲 大数据 */
+#include "ID3.h"
+#include "CsvReader.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+
+/*
+检查模型文件（ID3::save / ID3::load）：
+  1. 保存再加载的模型与原模型导出的代码相同，批量预测和逐行 predict 的结果相同（分类属性和数值属性各一个模型）
+  2. 截断的文件、文件头被改坏的文件（超大的属性数、越界的目标列）、节点被改坏的文件（子节点不在后面、属性越界、
+     类别越界）、字典被改坏的文件（重复取值、数值属性上不是数字的取值）都被拒绝，并且原有模型保持不变
+  3. 逐个字节改坏文件头和节点区时不崩溃；加载成功时预测也不会越界
+用法: model_test [csv 文件]
+*/
+
+const string MODEL_FILE = "model_test.id3m";
+const string CORRUPT_FILE = "model_test_corrupt.id3m"; // 加载的模型映射着 MODEL_FILE，改坏的内容写到另一个文件
+const size_t HEADER_SIZE = 32;
+const size_t NODE_SIZE = 16;
+
+int failures = 0;
+
+void check(bool ok, const string& what) {
+    if (!ok) {
+        cerr << "失败: " << what << endl;
+        failures++;
+    }
+}
+
+string readFile(const string& filename) {
+    ifstream in(filename, ios::binary);
+    stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+void writeFile(const string& filename, const string& content) {
+    ofstream out(filename, ios::binary | ios::trunc);
+    out << content;
+}
+
+void putI32(string& s, size_t offset, int value) {
+    memcpy(&s[offset], &value, 4);
+}
+
+string exported(const ID3& tree) {
+    ostringstream out;
+    tree.exportCpp(out, "f");
+    return out.str();
+}
+
+// 加载必须失败，并且 model 仍是原来的模型
+void expectRejected(ID3& model, const string& expected, const string& content, const string& what) {
+    writeFile(CORRUPT_FILE, content);
+    check(!model.load(CORRUPT_FILE), "load 接受了" + what);
+    check(exported(model) == expected, "拒绝" + what + "后原有模型被改动");
+}
+
+void runCase(const Dataset& data, const vector<string>& numeric, const string& name) {
+    ID3 tree;
+    tree.setNumericAttributes(numeric);
+    tree.train(data, "G3");
+    check(tree.save(MODEL_FILE), name + ": save 失败");
+    const string original = readFile(MODEL_FILE);
+    const string expected = exported(tree);
+
+    // 1. 往返
+    ID3 loaded;
+    check(loaded.load(MODEL_FILE), name + ": load 失败");
+    check(exported(loaded) == expected, name + ": 加载的模型导出的代码不同");
+    check(loaded.predictBatch(loaded.encodeBatch(data)) == tree.predictBatch(tree.encodeBatch(data)), name + ": 批量预测不同");
+    for (int r = 0; r < data.numRows(); r++) {
+        if (loaded.predict(data.row(r)) != tree.predict(data.row(r))) {
+            check(false, name + ": 第 " + to_string(r) + " 行 predict 不同");
+            break;
+        }
+    }
+
+    // 2. 损坏的文件：每次都加载到同一个模型上，失败后它必须保持原样
+    for (size_t length = 0; length < original.size(); length += 1 + length / 8)
+        expectRejected(loaded, expected, original.substr(0, length), name + "截断到 " + to_string(length) + " 字节的文件");
+
+    int numAttrs, target, numNodes;
+    memcpy(&numAttrs, &original[8], 4);
+    memcpy(&target, &original[12], 4);
+    memcpy(&numNodes, &original[16], 4);
+
+    string bad = original;
+    bad[0] = 'X';
+    expectRejected(loaded, expected, bad, "魔数错误的文件");
+    bad = original;
+    putI32(bad, 4, (int)MODEL_FILE_VERSION + 1);
+    expectRejected(loaded, expected, bad, "版本不符的文件");
+    bad = original;
+    putI32(bad, 8, 0x7FFFFFF0);
+    expectRejected(loaded, expected, bad, "属性数超过文件大小的文件");
+    bad = original;
+    putI32(bad, 12, numAttrs);
+    expectRejected(loaded, expected, bad, "目标列越界的文件");
+
+    // 找到第一个内部节点，分别改坏它的子节点下标和属性；再把第一个叶子的类别改成越界
+    for (int i = 0; i < numNodes; i++) {
+        const size_t at = HEADER_SIZE + NODE_SIZE * i;
+        int attr;
+        memcpy(&attr, &original[at], 4);
+        if (attr < 0)
+            continue;
+        bad = original;
+        putI32(bad, at + 4, i);
+        expectRejected(loaded, expected, bad, "子节点指向自己的文件");
+        bad = original;
+        putI32(bad, at, numAttrs);
+        expectRejected(loaded, expected, bad, "分裂属性越界的文件");
+        bad = original;
+        putI32(bad, at, target);
+        expectRejected(loaded, expected, bad, "在目标列上分裂的文件");
+        break;
+    }
+    for (int i = 0; i < numNodes; i++) {
+        const size_t at = HEADER_SIZE + NODE_SIZE * i;
+        int attr;
+        memcpy(&attr, &original[at], 4);
+        if (attr >= 0)
+            continue;
+        bad = original;
+        putI32(bad, at + 4, 1 << 20);
+        expectRejected(loaded, expected, bad, "叶子类别越界的文件");
+        break;
+    }
+
+    // 字典区：第 0 列（school，取值 GP、MS）的第二个取值改成第一个；数值列的第一个取值改成不是数字
+    const size_t dictStart = HEADER_SIZE + NODE_SIZE * numNodes;
+    const string school = string("\x02\0\0\0", 4) + "GP" + string("\x02\0\0\0", 4) + "MS";
+    size_t at = original.find(school, dictStart);
+    if (at != string::npos) {
+        bad = original;
+        bad.replace(at + 10, 2, "GP");
+        expectRejected(loaded, expected, bad, "字典里有重复取值的文件");
+    }
+    if (!numeric.empty()) {
+        const string column = string("\x03\0\0\0", 4) + "age" + string("\x01\0\0\0", 4);
+        at = original.find(column, dictStart);
+        check(at != string::npos, name + ": 模型文件里找不到数值列 age");
+        if (at != string::npos) {
+            bad = original;
+            bad[at + column.size() + 4 + 4] = 'x'; // 第一个取值的第一个字节
+            expectRejected(loaded, expected, bad, "数值列上有不是数字的取值的文件");
+        }
+    }
+
+    // 3. 逐个字节改坏文件头和节点区
+    for (size_t i = 0; i < dictStart; i++) {
+        bad = original;
+        bad[i] = (char)(bad[i] ^ 0xA5);
+        writeFile(CORRUPT_FILE, bad);
+        ID3 corrupted;
+        if (corrupted.load(CORRUPT_FILE))
+            corrupted.predictBatch(corrupted.encodeBatch(data));
+    }
+    cout << name << ": 原文件 " << original.size() << " 字节，" << numNodes << " 个节点" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    string csvFile = argc > 1 ? argv[1] : "../ID3实现/student-mat.csv";
+    Dataset data;
+    if (!loadCsv(csvFile, ';', data) || data.numRows() == 0) {
+        cerr << "无法读取数据文件: " << csvFile << endl;
+        return 1;
+    }
+
+    runCase(data, {}, "分类属性");
+    runCase(data, { "age", "absences", "G1", "G2" }, "数值属性");
+
+    remove(MODEL_FILE.c_str());
+    remove(CORRUPT_FILE.c_str());
+    if (failures > 0) {
+        cout << "测试失败，" << failures << " 处错误" << endl;
+        return 1;
+    }
+    cout << "测试通过" << endl;
+    return 0;
+}
\ No newline at end of file
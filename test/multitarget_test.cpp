@@ -0,0 +1,135 @@
+/* 2452214 霍宇哲 大数据 */
+#include "ID3.h"
+#include "CsvReader.h"
+#include "DataGenerator.h"
+#include "MultiTarget.h"
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <string>
+
+using namespace std;
+
+/*
+检查多目标训练（MultiTargetModel）：
+  1. 每个目标的树与单独用 ID3::train 训练的完全相同（比较 exportCpp 导出的代码，编码阈值取各树的并集），分类属性、数值属性
+     （包括同时是其它树属性的目标列）和生成的数据各一遍，串行和多线程各一遍
+  2. scanRoots 一遍扫描得到的计数与逐个目标直接统计的相同
+  3. 各棵树共享同一份字典；predictBatch 与各棵树在共用编码上的 predictBatch 相同
+  4. 目标列不存在、目标重复、数据为空时 train 返回 false
+用法: multitarget_test [csv 文件]
+*/
+
+int failures = 0;
+
+void check(bool ok, const string& what) {
+    if (!ok) {
+        cerr << "失败: " << what << endl;
+        failures++;
+    }
+}
+
+string exported(const ID3& tree) {
+    ostringstream out;
+    tree.exportCpp(out, "f");
+    return out.str();
+}
+
+void checkScan(const Dataset& data, const vector<string>& targets, const string& name) {
+    vector<int> indices;
+    for (const string& target : targets)
+        indices.push_back(data.findAttribute(target));
+    const vector<RootCounts> counts = MultiTargetModel::scanRoots(data, indices, 3);
+    for (size_t t = 0; t < indices.size(); t++) {
+        const vector<int>& labels = data.column(indices[t]);
+        const int numClasses = data.dictionary(indices[t]).size();
+        vector<int> classCounts(numClasses, 0);
+        for (int label : labels)
+            classCounts[label]++;
+        check(counts[t].classCounts == classCounts, name + ": 目标 " + targets[t] + " 的类别计数不对");
+        for (int j = 0; j < data.numAttributes(); j++) {
+            vector<int> table;
+            if (j != indices[t]) {
+                table.assign((size_t)data.dictionary(j).size() * numClasses, 0);
+                for (int r = 0; r < data.numRows(); r++)
+                    table[(size_t)data.code(r, j) * numClasses + labels[r]]++;
+            }
+            check(counts[t].tables[j] == table, name + ": 目标 " + targets[t] + " 第 " + to_string(j) + " 列的计数表不对");
+        }
+    }
+}
+
+void runCase(const Dataset& data, const vector<string>& targets, const vector<string>& numeric, const string& name) {
+    // 多目标模型给所有树使用同一组阈值区间编码没见过的数，导出的代码里包含它们，所以单独训练的树也换成各树阈值的并集
+    vector<ID3> singles(targets.size());
+    vector<vector<double>> thresholds;
+    for (size_t t = 0; t < targets.size(); t++) {
+        singles[t].setNumericAttributes(numeric);
+        singles[t].train(data, targets[t]);
+        singles[t].collectThresholds(thresholds);
+    }
+    vector<string> expected;
+    for (ID3& single : singles) {
+        single.setEncodingThresholds(thresholds);
+        expected.push_back(exported(single));
+    }
+
+    for (int threads : { 1, 4 }) {
+        MultiTargetOptions options;
+        options.threads = threads;
+        options.numericAttributes = numeric;
+        MultiTargetModel multi(options);
+        if (!multi.train(data, targets)) {
+            check(false, name + ": train 失败");
+            continue;
+        }
+        check(multi.targetCount() == (int)targets.size(), name + ": 目标数不对");
+        for (int t = 0; t < multi.targetCount(); t++) {
+            check(multi.targetName(t) == targets[t] && multi.findTarget(targets[t]) == t, name + ": 目标名不对");
+            check(exported(multi.tree(t)) == expected[t], name + ": " + to_string(threads) + " 个线程时目标 " + targets[t] + " 的树与单独训练的不同");
+            check(&multi.tree(t).dictionary(0) == &multi.tree(0).dictionary(0), name + ": 目标 " + targets[t] + " 的树复制了字典");
+        }
+
+        Dataset encoded = multi.encodeBatch(data);
+        vector<vector<int>> labels = multi.predictBatch(encoded);
+        for (int t = 0; t < multi.targetCount(); t++)
+            check(labels[t] == multi.tree(t).predictBatch(encoded), name + ": 目标 " + targets[t] + " 的批量预测不同");
+    }
+    checkScan(data, targets, name);
+    cout << name << ": " << targets.size() << " 个目标" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    string csvFile = argc > 1 ? argv[1] : "../ID3实现/student-mat.csv";
+    Dataset data;
+    if (!loadCsv(csvFile, ';', data) || data.numRows() == 0) {
+        cerr << "无法读取数据文件: " << csvFile << endl;
+        return 1;
+    }
+
+    // 1 - 3
+    runCase(data, { "G3", "G1", "G2", "higher", "Walc" }, {}, "student-mat 分类属性");
+    runCase(data, { "G3", "G1", "higher" }, { "age", "absences", "G1", "G2", "G3" }, "student-mat 数值属性");
+
+    GeneratorOptions generatorOptions;
+    generatorOptions.rows = 20000;
+    generatorOptions.attributes = 10;
+    generatorOptions.cardinality = 4;
+    generatorOptions.classes = 3;
+    generatorOptions.labelNoise = 0.1;
+    Dataset generated = DataGenerator(generatorOptions).generate();
+    runCase(generated, { "label", generated.attributeNames()[0], generated.attributeNames()[3] }, {}, "生成的数据");
+
+    // 4. 不合法的参数
+    MultiTargetModel invalid;
+    check(!invalid.train(data, { "G3", "no such column" }), "目标列不存在时 train 没有返回 false");
+    check(!invalid.train(data, { "G3", "G3" }), "目标重复时 train 没有返回 false");
+    check(!invalid.train(Dataset(data.attributeNames()), { "G3" }), "数据为空时 train 没有返回 false");
+
+    if (failures > 0) {
+        cout << "测试失败，" << failures << " 处错误" << endl;
+        return 1;
+    }
+    cout << "测试通过" << endl;
+    return 0;
+}
\ No newline at end of file
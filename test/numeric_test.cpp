@@ -0,0 +1,159 @@
+/* 2452214 霍宇哲 大数据 */
+#include "ID3.h"
+#include "CsvReader.h"
+#include "RandomForest.h"
+#include "MultiTarget.h"
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdio>
+
+using namespace std;
+
+/*
+检查数值属性上训练时没见过的数在各个预测入口上结果一致：
+在 student-mat 上把 age、absences、G1、G2 当作数值属性训练，再把测试数据改成没见过的数
+（absences 全部改成 77、G2 改成 7.5，部分行的 G1、age 改成随机的小数，少数行的 G1 改成不是数字的 "abc"），然后比较
+  1. 单棵树：predict（按数值比较）、encodeValue + predictCode、encodeBatch + predictBatch（列式和行优先两种）、predictRow，
+     以及保存再加载的模型
+  2. 随机森林：predict 与 encodeBatch + predictBatch / predictCode，每棵树的 predictCode 与它自己的 predict
+  3. 多目标模型：共用的 encodeBatch 对每个目标的树都与它自己的 predict 相同
+没见过的数都应该能预测，只有 "abc" 这样不是数字的取值才无法预测。
+用法: numeric_test [csv 文件]
+*/
+
+const string MODEL_FILE = "numeric_test.id3m";
+
+int failures = 0;
+
+void check(bool ok, const string& what) {
+    if (!ok) {
+        cerr << "失败: " << what << endl;
+        failures++;
+    }
+}
+
+// predict 的字符串结果与类别编码是否对应（无法预测时 predict 返回的是提示，不是任何一个类别）
+bool sameResult(const string& predicted, int code, const ValueDictionary& labels) {
+    if (code < 0)
+        return labels.find(predicted) < 0;
+    return predicted == labels.value(code);
+}
+
+// 确定的伪随机数，结果与平台无关
+unsigned int nextRandom(unsigned int& state) {
+    state = state * 1103515245u + 12345u;
+    return (state >> 8) & 0xFFFF;
+}
+
+int main(int argc, char* argv[]) {
+    string csvFile = argc > 1 ? argv[1] : "../ID3实现/student-mat.csv";
+    Dataset data;
+    if (!loadCsv(csvFile, ';', data) || data.numRows() == 0) {
+        cerr << "无法读取数据文件: " << csvFile << endl;
+        return 1;
+    }
+    const vector<string> numeric = { "age", "absences", "G1", "G2" };
+    const int numAttrs = data.numAttributes();
+
+    // 改成没见过的数
+    const int age = data.findAttribute("age"), absences = data.findAttribute("absences");
+    const int g1 = data.findAttribute("G1"), g2 = data.findAttribute("G2");
+    unsigned int state = 1;
+    Dataset changed(data.attributeNames());
+    for (int r = 0; r < data.numRows(); r++) {
+        vector<string> row = data.row(r);
+        row[absences] = "77";
+        row[g2] = "7.5";
+        if (r % 3 == 0) {
+            row[g1] = to_string(nextRandom(state) % 400 / 20.0);
+            row[age] = to_string(14 + nextRandom(state) % 100 / 10.0);
+        }
+        if (r % 7 == 0)
+            row[g1] = "abc";
+        changed.appendRow(row);
+    }
+    changed.sortDictionaries();
+    const int n = changed.numRows();
+
+    // 1. 单棵树
+    ID3 tree;
+    tree.setNumericAttributes(numeric);
+    tree.train(data, "G3");
+    Dataset encoded = tree.encodeBatch(changed);
+    vector<int> batch = tree.predictBatch(encoded);
+    vector<int> rowMajor((size_t)n * numAttrs);
+    vector<int> codes(numAttrs);
+    int routed = 0;
+    for (int r = 0; r < n; r++) {
+        for (int j = 0; j < numAttrs; j++) {
+            codes[j] = encoded.code(r, j);
+            rowMajor[(size_t)r * numAttrs + j] = codes[j];
+            check(codes[j] == tree.encodeValue(j, changed.valueAt(r, j)), "第 " + to_string(r) + " 行第 " + to_string(j) + " 列 encodeValue 与 encodeBatch 不同");
+        }
+        const int label = tree.predictCode(codes.data());
+        check(label == batch[r] && label == tree.predictRow(encoded, r), "第 " + to_string(r) + " 行 predictCode / predictRow / predictBatch 不同");
+        check(sameResult(tree.predict(changed.row(r)), label, tree.labelDictionary()), "第 " + to_string(r) + " 行 predict 与 predictCode 不同");
+        check(label >= 0 || changed.valueAt(r, g1) == "abc", "第 " + to_string(r) + " 行没见过的数无法预测");
+        routed += label >= 0;
+    }
+    vector<int> fromCodes(n);
+    tree.predictBatch(rowMajor.data(), n, fromCodes.data());
+    check(fromCodes == batch, "行优先编码的批量预测与列式的不同");
+
+    check(tree.save(MODEL_FILE), "save 失败");
+    {
+        ID3 loaded;
+        check(loaded.load(MODEL_FILE), "load 失败");
+        Dataset reencoded = loaded.encodeBatch(changed);
+        bool sameCodes = true;
+        for (int j = 0; j < numAttrs; j++)
+            sameCodes = sameCodes && reencoded.column(j) == encoded.column(j);
+        check(sameCodes, "加载的模型编码不同");
+        check(loaded.predictBatch(reencoded) == batch, "加载的模型预测不同");
+    }
+    remove(MODEL_FILE.c_str());
+    cout << "单棵树: " << routed << " / " << n << " 行给出预测" << endl;
+
+    // 2. 随机森林
+    ForestOptions forestOptions;
+    forestOptions.trees = 15;
+    forestOptions.numericAttributes = numeric;
+    RandomForest forest(forestOptions);
+    forest.train(data, "G3");
+    Dataset forestEncoded = forest.encodeBatch(changed);
+    vector<int> votes = forest.predictBatch(forestEncoded);
+    for (int r = 0; r < n; r++) {
+        for (int j = 0; j < numAttrs; j++)
+            codes[j] = forestEncoded.code(r, j);
+        check(forest.predictCode(codes.data()) == votes[r], "森林第 " + to_string(r) + " 行 predictCode 与批量预测不同");
+        check(sameResult(forest.predict(changed.row(r)), votes[r], forest.labelDictionary()), "森林第 " + to_string(r) + " 行 predict 与批量预测不同");
+        for (int t = 0; t < forest.treeCount(); t++) {
+            const ID3& member = forest.tree(t);
+            check(sameResult(member.predict(changed.row(r)), member.predictCode(codes.data()), member.labelDictionary()),
+                "森林第 " + to_string(t) + " 棵树第 " + to_string(r) + " 行在共用的编码上与它自己的 predict 不同");
+        }
+    }
+    cout << "随机森林: " << forest.treeCount() << " 棵树" << endl;
+
+    // 3. 多目标模型（G1 既是目标也是其它树的数值属性）
+    MultiTargetOptions multiOptions;
+    multiOptions.numericAttributes = { "age", "absences", "G1", "G2", "G3" };
+    MultiTargetModel multi(multiOptions);
+    multi.train(data, { "G3", "G1", "Walc" });
+    vector<vector<int>> multiLabels = multi.predictBatch(multi.encodeBatch(changed));
+    for (int t = 0; t < multi.targetCount(); t++) {
+        const ID3& member = multi.tree(t);
+        for (int r = 0; r < n; r++)
+            check(sameResult(member.predict(changed.row(r)), multiLabels[t][r], member.labelDictionary()),
+                "目标 " + multi.targetName(t) + " 第 " + to_string(r) + " 行在共用的编码上与它自己的 predict 不同");
+    }
+    cout << "多目标模型: " << multi.targetCount() << " 个目标" << endl;
+
+    if (failures > 0) {
+        cout << "测试失败，" << failures << " 处错误" << endl;
+        return 1;
+    }
+    cout << "测试通过" << endl;
+    return 0;
+}
\ No newline at end of file
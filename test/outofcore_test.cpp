@@ -0,0 +1,95 @@
+/* 2452214 霍宇哲 大数据 */
+#include "ID3.h"
+#include "CsvReader.h"
+#include "DataGenerator.h"
+#include "DatasetCache.h"
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <cstdio>
+
+using namespace std;
+
+/*
+检查外存训练（ID3::trainOutOfCore）：在缓存文件上按层扫描训练的树，与把同一份数据放在内存里用 train 训练的完全相同
+（比较 exportCpp 导出的代码）。
+  1. student-mat：分类属性和数值属性，串行和多线程
+  2. 生成的数据：行数超过 OUT_OF_CORE_CHUNK_ROWS，每层要读多个行块
+  3. 增量模式和不存在的文件返回 false
+用法: outofcore_test [csv 文件]
+*/
+
+const string CACHE_FILE = "outofcore_test.id3d";
+
+int failures = 0;
+
+void check(bool ok, const string& what) {
+    if (!ok) {
+        cerr << "失败: " << what << endl;
+        failures++;
+    }
+}
+
+string exported(const ID3& tree) {
+    ostringstream out;
+    tree.exportCpp(out, "f");
+    return out.str();
+}
+
+void runCase(const Dataset& data, const string& target, const vector<string>& numeric, const string& name) {
+    ID3 inMemory;
+    inMemory.setNumericAttributes(numeric);
+    inMemory.train(data, target);
+    const string expected = exported(inMemory);
+
+    check(saveDatasetCache(data, CACHE_FILE), name + ": 写缓存失败");
+    for (int threads : { 1, 3 }) {
+        ID3 outOfCore;
+        outOfCore.setNumericAttributes(numeric);
+        outOfCore.setThreadCount(threads);
+        check(outOfCore.trainOutOfCore(CACHE_FILE, target), name + ": trainOutOfCore 失败");
+        check(exported(outOfCore) == expected, name + ": " + to_string(threads) + " 个线程的外存训练与内存训练的树不同");
+    }
+    cout << name << ": " << data.numRows() << " 行，" << inMemory.nodeCount() << " 个节点" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    string csvFile = argc > 1 ? argv[1] : "../ID3实现/student-mat.csv";
+    Dataset data;
+    if (!loadCsv(csvFile, ';', data) || data.numRows() == 0) {
+        cerr << "无法读取数据文件: " << csvFile << endl;
+        return 1;
+    }
+
+    // 1. student-mat
+    runCase(data, "G3", {}, "student-mat 分类属性");
+    runCase(data, "G3", { "age", "absences", "G1", "G2" }, "student-mat 数值属性");
+
+    // 2. 生成的数据，行数是行块的两倍多
+    GeneratorOptions options;
+    options.rows = OUT_OF_CORE_CHUNK_ROWS * 2 + 123;
+    options.attributes = 10;
+    options.cardinality = 6;
+    options.classes = 4;
+    options.labelNoise = 0.1;
+    Dataset generated = DataGenerator(options).generate();
+    runCase(generated, "label", {}, "生成的数据");
+
+    // 3. 不支持的情况
+    ID3 incremental;
+    incremental.setIncremental(true);
+    check(!incremental.trainOutOfCore(CACHE_FILE, "label"), "增量模式下 trainOutOfCore 没有返回 false");
+    ID3 missing;
+    check(!missing.trainOutOfCore(CACHE_FILE + ".missing", "label"), "缓存文件不存在时 trainOutOfCore 没有返回 false");
+    ID3 noTarget;
+    check(!noTarget.trainOutOfCore(CACHE_FILE, "no such column"), "目标列不存在时 trainOutOfCore 没有返回 false");
+
+    remove(CACHE_FILE.c_str());
+    if (failures > 0) {
+        cout << "测试失败，" << failures << " 处错误" << endl;
+        return 1;
+    }
+    cout << "测试通过" << endl;
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+/* 2452214 霍宇哲 大数据 */
+#include "ID3.h"
+#include "CsvReader.h"
+#include "DataGenerator.h"
+#include "RandomForest.h"
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <string>
+
+using namespace std;
+
+/*
+检查多线程训练的结果与线程数无关：
+  1. 单棵树：并行评估属性、并行构建子树得到的树与串行的完全相同（比较 exportCpp 导出的代码），
+     数据足够大，节点的工作量超过 PARALLEL_MIN_WORK、子树超过 TASK_MIN_ROWS
+  2. 随机森林：不同线程数训练出的每棵树都相同，批量预测（分段并行）与逐行 predictCode 相同
+  3. 随机森林的各棵树共享同一份字典，不各自复制
+用法: parallel_test [csv 文件]
+*/
+
+int failures = 0;
+
+void check(bool ok, const string& what) {
+    if (!ok) {
+        cerr << "失败: " << what << endl;
+        failures++;
+    }
+}
+
+string exported(const ID3& tree) {
+    ostringstream out;
+    tree.exportCpp(out, "f");
+    return out.str();
+}
+
+void checkTree(const Dataset& data, const string& target, const vector<string>& numeric, const string& name) {
+    ID3 serial;
+    serial.setNumericAttributes(numeric);
+    serial.train(data, target);
+    const string expected = exported(serial);
+    for (int threads : { 2, 4 }) {
+        ID3 parallel;
+        parallel.setNumericAttributes(numeric);
+        parallel.setThreadCount(threads);
+        parallel.train(data, target);
+        check(exported(parallel) == expected, name + ": " + to_string(threads) + " 个线程构建的树与串行的不同");
+    }
+    cout << name << ": " << serial.nodeCount() << " 个节点" << endl;
+}
+
+void checkForest(const Dataset& data, const string& target, const vector<string>& numeric, const string& name) {
+    ForestOptions options;
+    options.trees = 12;
+    options.numericAttributes = numeric;
+    options.threads = 1;
+    RandomForest serial(options);
+    check(serial.train(data, target), name + ": 森林训练失败");
+    options.threads = 3;
+    RandomForest parallel(options);
+    check(parallel.train(data, target), name + ": 森林训练失败");
+
+    check(serial.treeCount() == parallel.treeCount(), name + ": 树的棵数不同");
+    for (int t = 0; t < serial.treeCount() && t < parallel.treeCount(); t++) {
+        check(exported(serial.tree(t)) == exported(parallel.tree(t)), name + ": 第 " + to_string(t) + " 棵树与线程数有关");
+        check(&parallel.tree(t).dictionary(0) == &parallel.tree(0).dictionary(0), name + ": 第 " + to_string(t) + " 棵树复制了字典");
+    }
+
+    Dataset encoded = parallel.encodeBatch(data);
+    vector<int> batch = parallel.predictBatch(encoded);
+    check(batch == serial.predictBatch(encoded), name + ": 批量预测与线程数有关");
+    vector<int> codes(encoded.numAttributes());
+    for (int r = 0; r < encoded.numRows(); r++) {
+        for (int j = 0; j < encoded.numAttributes(); j++)
+            codes[j] = encoded.code(r, j);
+        if (parallel.predictCode(codes.data()) != batch[r]) {
+            check(false, name + ": 第 " + to_string(r) + " 行 predictCode 与批量预测不同");
+            break;
+        }
+    }
+    cout << name << ": 森林 " << parallel.treeCount() << " 棵树" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    string csvFile = argc > 1 ? argv[1] : "../ID3实现/student-mat.csv";
+    Dataset data;
+    if (!loadCsv(csvFile, ';', data) || data.numRows() == 0) {
+        cerr << "无法读取数据文件: " << csvFile << endl;
+        return 1;
+    }
+
+    GeneratorOptions options;
+    options.rows = 60000;
+    options.attributes = 12;
+    options.cardinality = 5;
+    options.classes = 3;
+    options.labelNoise = 0.15;
+    Dataset generated = DataGenerator(options).generate();
+
+    // 1. 单棵树
+    checkTree(data, "G3", {}, "student-mat 分类属性");
+    checkTree(data, "G3", { "age", "absences", "G1", "G2" }, "student-mat 数值属性");
+    checkTree(generated, "label", {}, "生成的数据");
+
+    // 2、3. 随机森林
+    checkForest(data, "G3", {}, "student-mat 分类属性");
+    checkForest(data, "G3", { "age", "absences", "G1", "G2" }, "student-mat 数值属性");
+    checkForest(generated, "label", {}, "生成的数据");
+
+    if (failures > 0) {
+        cout << "测试失败，" << failures << " 处错误" << endl;
+        return 1;
+    }
+    cout << "测试通过" << endl;
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,177 @@
+/* 2452214 霍宇哲 大数据 */
+#include "ID3.h"
+#include "CsvReader.h"
+#include "DataGenerator.h"
+#include "Random.h"
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <string>
+#include <cstdio>
+
+using namespace std;
+
+/*
+检查后剪枝（ID3::pruneReducedError / ID3::prunePessimistic）：
+  1. 减少错误剪枝后，在所用的验证集上的准确率不会下降（多种随机划分，分类属性、数值属性和加了噪声的生成数据）
+  2. PruneStats 与剪枝前后的 nodeCount、treeDepth、modelBytes 一致，节点数和平均路径不会增加
+  3. 剪枝后 predict 与批量预测相同，保存再加载的模型导出的代码相同；对加载的模型剪枝与对训练的模型剪枝结果相同
+  4. 没有训练的模型、增量模式的模型、没有目标列的数据都不能剪枝
+用法: prune_test [csv 文件]
+*/
+
+const string MODEL_FILE = "prune_test.id3m";
+
+int failures = 0;
+
+void check(bool ok, const string& what) {
+    if (!ok) {
+        cerr << "失败: " << what << endl;
+        failures++;
+    }
+}
+
+string exported(const ID3& tree) {
+    ostringstream out;
+    tree.exportCpp(out, "f");
+    return out.str();
+}
+
+// 在 data 上预测正确的行数（目标值没见过的行算错）
+int correctRows(const ID3& tree, const Dataset& data, const string& target) {
+    Dataset encoded = tree.encodeBatch(data);
+    vector<int> predicted = tree.predictBatch(encoded);
+    const vector<int>& labels = encoded.column(encoded.findAttribute(target));
+    int correct = 0;
+    for (int r = 0; r < encoded.numRows(); r++)
+        correct += labels[r] >= 0 && predicted[r] == labels[r];
+    return correct;
+}
+
+void checkStats(const ID3& tree, const PruneStats& stats, int nodesBefore, int depthBefore, size_t bytesBefore, const string& name) {
+    check(stats.nodesBefore == nodesBefore && stats.depthBefore == depthBefore && stats.bytesBefore == bytesBefore, name + ": 剪枝前的规模不对");
+    check(stats.nodesAfter == tree.nodeCount() && stats.depthAfter == tree.treeDepth() && stats.bytesAfter == tree.modelBytes(), name + ": 剪枝后的规模不对");
+    check(stats.nodesAfter <= stats.nodesBefore && stats.depthAfter <= stats.depthBefore && stats.bytesAfter <= stats.bytesBefore, name + ": 剪枝后模型变大了");
+    check((stats.subtreesPruned > 0) == (stats.nodesAfter < stats.nodesBefore), name + ": 剪掉的子树数与节点数不符");
+    check(stats.pathAfter <= stats.pathBefore, name + ": 剪枝后平均路径变长了");
+}
+
+// 剪枝后 predict 与批量预测相同，保存再加载不变
+void checkPruned(const ID3& tree, const Dataset& data, const string& name) {
+    vector<int> batch = tree.predictBatch(tree.encodeBatch(data));
+    const ValueDictionary& labels = tree.labelDictionary();
+    for (int r = 0; r < data.numRows(); r++) {
+        const string predicted = tree.predict(data.row(r));
+        if (batch[r] >= 0 ? predicted != labels.value(batch[r]) : labels.find(predicted) >= 0) {
+            check(false, name + ": 剪枝后第 " + to_string(r) + " 行 predict 与批量预测不同");
+            break;
+        }
+    }
+    check(tree.save(MODEL_FILE), name + ": 剪枝后 save 失败");
+    ID3 loaded;
+    check(loaded.load(MODEL_FILE) && exported(loaded) == exported(tree), name + ": 剪枝后保存再加载的模型不同");
+}
+
+// 打乱 data 的行，前 3/4 训练、后 1/4 验证，训练后做减少错误剪枝
+void runReducedError(const Dataset& data, const string& target, const vector<string>& numeric, uint64_t seed, const string& name) {
+    vector<int> order(data.numRows());
+    for (int i = 0; i < data.numRows(); i++)
+        order[i] = i;
+    SplitMix64 rng(seed);
+    for (int i = data.numRows() - 1; i > 0; i--)
+        swap(order[i], order[rng.below(i + 1)]);
+    const int growSize = data.numRows() * 3 / 4;
+    Dataset grow = data.select(vector<int>(order.begin(), order.begin() + growSize));
+    Dataset validation = data.select(vector<int>(order.begin() + growSize, order.end()));
+
+    ID3 tree;
+    tree.setNumericAttributes(numeric);
+    tree.train(grow, target);
+    const int nodesBefore = tree.nodeCount(), depthBefore = tree.treeDepth();
+    const size_t bytesBefore = tree.modelBytes();
+    const int correctBefore = correctRows(tree, validation, target);
+    check(tree.save(MODEL_FILE), name + ": save 失败");
+
+    PruneStats stats;
+    if (!tree.pruneReducedError(grow, validation, &stats)) {
+        check(false, name + ": pruneReducedError 失败");
+        return;
+    }
+    const int correctAfter = correctRows(tree, validation, target);
+    check(correctAfter >= correctBefore, name + ": 剪枝后验证集上的准确率下降了 (" + to_string(correctBefore) + " -> " + to_string(correctAfter) + ")");
+    checkStats(tree, stats, nodesBefore, depthBefore, bytesBefore, name);
+
+    ID3 loaded;
+    check(loaded.load(MODEL_FILE) && loaded.pruneReducedError(grow, validation), name + ": 加载的模型剪枝失败");
+    check(exported(loaded) == exported(tree), name + ": 对加载的模型剪枝与对训练的模型剪枝结果不同");
+    checkPruned(tree, validation, name);
+
+    if (seed == 1)
+        cout << name << ": " << nodesBefore << " -> " << stats.nodesAfter << " 个节点，验证集正确 "
+            << correctBefore << " -> " << correctAfter << " / " << validation.numRows() << endl;
+}
+
+void runPessimistic(const Dataset& data, const string& target, const vector<string>& numeric, const string& name) {
+    ID3 tree;
+    tree.setNumericAttributes(numeric);
+    tree.train(data, target);
+    const int nodesBefore = tree.nodeCount(), depthBefore = tree.treeDepth();
+    const size_t bytesBefore = tree.modelBytes();
+    PruneStats stats;
+    if (!tree.prunePessimistic(data, &stats)) {
+        check(false, name + ": prunePessimistic 失败");
+        return;
+    }
+    checkStats(tree, stats, nodesBefore, depthBefore, bytesBefore, name + " 悲观剪枝");
+    checkPruned(tree, data, name + " 悲观剪枝");
+    cout << name << " 悲观剪枝: " << nodesBefore << " -> " << stats.nodesAfter << " 个节点" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    string csvFile = argc > 1 ? argv[1] : "../ID3实现/student-mat.csv";
+    Dataset data;
+    if (!loadCsv(csvFile, ';', data) || data.numRows() == 0) {
+        cerr << "无法读取数据文件: " << csvFile << endl;
+        return 1;
+    }
+    const vector<string> numeric = { "age", "absences", "G1", "G2" };
+
+    GeneratorOptions options;
+    options.rows = 6000;
+    options.attributes = 8;
+    options.cardinality = 5;
+    options.classes = 3;
+    options.labelNoise = 0.3;
+    Dataset generated = DataGenerator(options).generate();
+
+    // 1 - 3
+    for (uint64_t seed = 1; seed <= 10; seed++) {
+        runReducedError(data, "G3", {}, seed, "student-mat 分类属性");
+        runReducedError(data, "G3", numeric, seed, "student-mat 数值属性");
+        runReducedError(data, "higher", numeric, seed, "student-mat 目标 higher");
+    }
+    for (uint64_t seed = 1; seed <= 3; seed++)
+        runReducedError(generated, "label", {}, seed, "生成的数据");
+    runPessimistic(data, "G3", {}, "student-mat 分类属性");
+    runPessimistic(data, "G3", numeric, "student-mat 数值属性");
+    runPessimistic(generated, "label", {}, "生成的数据");
+
+    // 4. 不能剪枝的情况
+    ID3 untrained;
+    check(!untrained.pruneReducedError(data, data) && !untrained.prunePessimistic(data), "没有训练的模型剪枝没有返回 false");
+    ID3 incremental;
+    incremental.setIncremental(true);
+    incremental.train(data, "G3");
+    check(!incremental.pruneReducedError(data, data) && !incremental.prunePessimistic(data), "增量模式的模型剪枝没有返回 false");
+    ID3 tree;
+    tree.train(data, "G3");
+    check(!tree.pruneReducedError(data, generated) && !tree.prunePessimistic(generated), "没有目标列的数据剪枝没有返回 false");
+
+    remove(MODEL_FILE.c_str());
+    if (failures > 0) {
+        cout << "测试失败，" << failures << " 处错误" << endl;
+        return 1;
+    }
+    cout << "测试通过" << endl;
+    return 0;
+}
\ No newline at end of file
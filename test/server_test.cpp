@@ -0,0 +1,185 @@
+/* 2452214 霍宇哲 大数据 */
+#include "ID3.h"
+#include "CsvReader.h"
+#include "PredictionService.h"
+#include <iostream>
+#include <vector>
+#include <string>
+#include <thread>
+#include <map>
+#include <cstdio>
+#include <cstdlib>
+
+using namespace std;
+
+/*
+检查本机预测服务（PredictionServer / PredictionClient）：服务端返回的类别与在本进程里对同样的编码调用 ID3::predictBatch 相同
+  1. TCP 回环（端口 0，由系统分配）：逐行同步预测，以及一次发出整个数据集
+  2. 多个连接同时流水线地发出不同行数的请求，响应按请求号对应；统计里的请求数、行数与发出的一致，
+     并且同时到达的请求被拼成了微批（微批数少于请求数）
+  3. 越界的编码不会让服务出错，结果与 predictBatch 相同；属性数不对的请求得到错误响应并断开，服务继续为其它连接工作
+  4. Unix 域套接字（Windows 上跳过），SHUTDOWN 请求让 wait 返回
+用法: server_test [csv 文件]
+*/
+
+const string SOCKET_FILE = "server_test.sock";
+const int CONNECTIONS = 4;
+const int REQUESTS_PER_CONNECTION = 200;
+const int DEPTH = 8;
+
+int failures = 0;
+
+void check(bool ok, const string& what) {
+    if (!ok) {
+        cerr << "失败: " << what << endl;
+        failures++;
+    }
+}
+
+// statsJson 里某个键的数值
+double jsonNumber(const string& json, const string& key) {
+    size_t at = json.find("\"" + key + "\":");
+    return at == string::npos ? -1 : atof(json.c_str() + at + key.size() + 3);
+}
+
+// 第 r 行开始的 rows 行，以及期望的结果
+struct Request {
+    int first;
+    int rows;
+};
+
+// 一个连接：流水线地发出 REQUESTS_PER_CONNECTION 个请求，在途最多 DEPTH 个；返回错误数
+int runConnection(int port, int index, const vector<int>& codes, const vector<int>& expected, int numAttrs) {
+    PredictionClient client;
+    if (!client.connectTcp("127.0.0.1", port))
+        return 1;
+    const int numRows = (int)expected.size();
+    map<unsigned int, Request> inFlight;
+    int errors = 0, sent = 0, received = 0;
+    while (received < REQUESTS_PER_CONNECTION) {
+        while (sent < REQUESTS_PER_CONNECTION && (int)inFlight.size() < DEPTH) {
+            Request request;
+            request.rows = 1 + (sent + index) % 5;
+            request.first = (sent * 37 + index * 101) % (numRows - request.rows);
+            unsigned int id = client.sendPredict(codes.data() + (size_t)request.first * numAttrs, request.rows, numAttrs);
+            if (id == 0)
+                return errors + 1;
+            inFlight[id] = request;
+            sent++;
+        }
+        unsigned int id;
+        vector<int> labels;
+        if (!client.receivePredict(id, labels) || inFlight.count(id) == 0)
+            return errors + 1;
+        const Request request = inFlight[id];
+        inFlight.erase(id);
+        if (labels != vector<int>(expected.begin() + request.first, expected.begin() + request.first + request.rows))
+            errors++;
+        received++;
+    }
+    return errors;
+}
+
+int main(int argc, char* argv[]) {
+    string csvFile = argc > 1 ? argv[1] : "../ID3实现/student-mat.csv";
+    Dataset data;
+    if (!loadCsv(csvFile, ';', data) || data.numRows() == 0) {
+        cerr << "无法读取数据文件: " << csvFile << endl;
+        return 1;
+    }
+
+    ID3 model;
+    model.setNumericAttributes({ "age", "absences", "G1", "G2" });
+    model.train(data, "G3");
+    const int numAttrs = (int)model.attributeNames().size();
+    const int numRows = data.numRows();
+    Dataset encoded = model.encodeBatch(data);
+    vector<int> codes((size_t)numRows * numAttrs);
+    for (int r = 0; r < numRows; r++)
+        for (int j = 0; j < numAttrs; j++)
+            codes[(size_t)r * numAttrs + j] = encoded.code(r, j);
+    vector<int> expected(numRows);
+    model.predictBatch(codes.data(), numRows, expected.data());
+
+    ServerOptions options;
+    options.port = 0;
+    options.maxDelayMicros = 2000;
+    options.statsIntervalSeconds = 0;
+    PredictionServer server(model, options);
+    if (!server.start()) {
+        cerr << "无法启动预测服务" << endl;
+        return 1;
+    }
+
+    // 1. 同步预测
+    PredictionClient client;
+    check(client.connectTcp("127.0.0.1", server.port()), "无法连接 TCP 端口");
+    vector<int> labels;
+    for (int r = 0; r < numRows; r++) {
+        if (!client.predict(codes.data() + (size_t)r * numAttrs, 1, numAttrs, labels) || labels.size() != 1 || labels[0] != expected[r]) {
+            check(false, "第 " + to_string(r) + " 行同步预测的结果不同");
+            break;
+        }
+    }
+    check(client.predict(codes.data(), numRows, numAttrs, labels) && labels == expected, "整个数据集一次预测的结果不同");
+
+    // 2. 多个连接流水线地并发请求
+    vector<int> errors(CONNECTIONS, 0);
+    vector<thread> workers;
+    for (int c = 0; c < CONNECTIONS; c++)
+        workers.push_back(thread([&, c] { errors[c] = runConnection(server.port(), c, codes, expected, numAttrs); }));
+    for (thread& worker : workers)
+        worker.join();
+    for (int c = 0; c < CONNECTIONS; c++)
+        check(errors[c] == 0, "第 " + to_string(c) + " 个连接有 " + to_string(errors[c]) + " 个响应不对");
+
+    long long requests = numRows + 1, rows = 2LL * numRows;
+    for (int c = 0; c < CONNECTIONS; c++)
+        for (int sent = 0; sent < REQUESTS_PER_CONNECTION; sent++, requests++)
+            rows += 1 + (sent + c) % 5;
+    string json;
+    check(client.serverStats(json), "取服务端统计失败");
+    check(jsonNumber(json, "requests") == requests && jsonNumber(json, "rows") == rows, "统计的请求数或行数不对: " + json);
+    check(jsonNumber(json, "batches") > 0 && jsonNumber(json, "batches") < requests, "并发的请求没有拼成微批: " + json);
+    cout << "TCP: " << json << endl;
+
+    // 3. 越界的编码；属性数不对的请求
+    vector<int> invalid(codes.begin(), codes.begin() + (size_t)4 * numAttrs);
+    invalid[0] = -5;
+    invalid[numAttrs + 1] = 1 << 20;
+    invalid[2 * numAttrs + 2] = -1;
+    invalid[3 * numAttrs + 3] = 1000;
+    vector<int> invalidExpected(4);
+    model.predictBatch(invalid.data(), 4, invalidExpected.data());
+    check(client.predict(invalid.data(), 4, numAttrs, labels) && labels == invalidExpected, "越界编码的预测结果不同");
+
+    PredictionClient bad;
+    check(bad.connectTcp("127.0.0.1", server.port()), "无法连接 TCP 端口");
+    check(!bad.predict(codes.data(), 1, numAttrs + 1, labels), "属性数不对的请求没有得到错误响应");
+    check(client.predict(codes.data(), numRows, numAttrs, labels) && labels == expected, "错误的请求之后其它连接的预测不对");
+    server.stop();
+
+#ifndef _WIN32
+    // 4. Unix 域套接字和 SHUTDOWN
+    ServerOptions unixOptions;
+    unixOptions.unixPath = SOCKET_FILE;
+    unixOptions.statsIntervalSeconds = 0;
+    PredictionServer unixServer(model, unixOptions);
+    check(unixServer.start(), "无法在 Unix 域套接字上启动");
+    PredictionClient unixClient;
+    check(unixClient.connectUnix(SOCKET_FILE), "无法连接 Unix 域套接字");
+    check(unixClient.predict(codes.data(), numRows, numAttrs, labels) && labels == expected, "Unix 域套接字上的预测结果不同");
+    check(unixClient.shutdownServer(), "SHUTDOWN 请求失败");
+    unixServer.wait();
+    unixServer.stop();
+    remove(SOCKET_FILE.c_str());
+    cout << "Unix 域套接字: " << unixServer.statsJson() << endl;
+#endif
+
+    if (failures > 0) {
+        cout << "测试失败，" << failures << " 处错误" << endl;
+        return 1;
+    }
+    cout << "测试通过" << endl;
+    return 0;
+}
\ No newline at end of file
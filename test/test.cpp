@@ -1,4 +1,4 @@
-/* 2452214   */
+/* 2452214 霍宇哲 大数据 */
 #include "./ID3.h"
 #include <iostream>
 #include <fstream>
@@ -10,23 +10,23 @@
 using namespace std;
 
 /*
-ļֻID3.cppID3.hṩID3㷨(ʵڶӦļ)
-ͬʱļȡݼļID3зࡣ
+该文件只调用ID3.cpp和ID3.h提供的ID3算法(具体实现在对应文件中完成)
+同时该文件会读取数据集文件并用ID3进行分类。
 */
 
-// ȡCSVļ
+// 读取CSV文件
 vector<vector<string>> readCSV(const string& filename, char delimiter = ',') {
     vector<vector<string>> data;
     ifstream file(filename);
     string line;
 
     if (!file.is_open()) {
-        cerr << "޷ļ: " << filename << endl;
+        cerr << "无法打开文件: " << filename << endl;
         return data;
     }
 
     while (getline(file, line)) {
-        // 
+        // 跳过空行
         if (line.empty()) continue;
 
         vector<string> row;
@@ -44,18 +44,18 @@ vector<vector<string>> readCSV(const string& filename, char delimiter = ',') {
     return data;
 }
 
-// ɢ򵥵ĵȿ䣩
+// 将连续属性离散化（简单的等宽分箱）
 vector<string> discretizeNumericAttribute(const vector<double>& values, int bins = 3) {
     vector<string> discretizedValues;
 
     if (values.empty()) return discretizedValues;
 
-    // ҵСֵֵ
+    // 找到最小值和最大值
     double minVal = *min_element(values.begin(), values.end());
     double maxVal = *max_element(values.begin(), values.end());
     double binWidth = (maxVal - minVal) / bins;
 
-    // ÿֵз
+    // 对每个值进行分箱
     for (double val : values) {
         if (val == maxVal) {
             discretizedValues.push_back("bin_" + to_string(bins - 1));
@@ -69,17 +69,17 @@ vector<string> discretizeNumericAttribute(const vector<double>& values, int bins
     return discretizedValues;
 }
 
-// ׼ݼɢ
+// 准备数据集：将连续属性离散化
 vector<vector<string>> prepareDataset(const vector<vector<string>>& rawData) {
     if (rawData.empty()) return {};
 
     vector<vector<string>> preparedData;
-    int numFeatures = rawData[0].size() - 1; // һ
+    int numFeatures = rawData[0].size() - 1; // 最后一列是类别
 
-    // Ϊÿ𣩴洢ֵ
+    // 为每个特征（除了类别）存储数值
     vector<vector<double>> numericFeatures(numFeatures);
 
-    // ռֵ
+    // 收集数值
     for (const auto& row : rawData) {
         if (row.size() < numFeatures + 1) continue;
 
@@ -94,25 +94,25 @@ vector<vector<string>> prepareDataset(const vector<vector<string>>& rawData) {
         }
     }
 
-    // ɢÿ
+    // 离散化每个特征
     vector<vector<string>> discretizedFeatures(numFeatures);
     for (int i = 0; i < numFeatures; i++) {
         discretizedFeatures[i] = discretizeNumericAttribute(numericFeatures[i], 3);
     }
 
-    // ɢݼ
+    // 构建离散化后的数据集
     for (size_t rowIdx = 0; rowIdx < rawData.size(); rowIdx++) {
         const auto& row = rawData[rowIdx];
         if (row.size() < numFeatures + 1) continue;
 
         vector<string> newRow;
 
-        // ɢֵ
+        // 添加离散化后的特征值
         for (int i = 0; i < numFeatures; i++) {
             newRow.push_back(discretizedFeatures[i][rowIdx]);
         }
 
-        // һԪأ
+        // 添加类别（最后一个元素）
         newRow.push_back(row.back());
 
         preparedData.push_back(newRow);
@@ -121,34 +121,34 @@ vector<vector<string>> prepareDataset(const vector<vector<string>>& rawData) {
     return preparedData;
 }
 
-// ѵͲԼ80%ѵ20%ԣ
+// 划分训练集和测试集（80%训练，20%测试）
 void splitDataset(const vector<vector<string>>& data,
     vector<vector<string>>& trainData,
     vector<vector<string>>& testData,
     float trainRatio = 0.8) {
     if (data.empty()) return;
 
-    // ݲ˳
+    // 复制数据并打乱顺序
     vector<vector<string>> shuffledData = data;
     random_shuffle(shuffledData.begin(), shuffledData.end());
 
-    // ѵС
+    // 计算训练集大小
     size_t trainSize = static_cast<size_t>(shuffledData.size() * trainRatio);
 
-    // ݼ
+    // 划分数据集
     trainData.assign(shuffledData.begin(), shuffledData.begin() + trainSize);
     testData.assign(shuffledData.begin() + trainSize, shuffledData.end());
 }
 
-// ӡݼϢ
+// 打印数据集信息
 void printDatasetInfo(const vector<vector<string>>& data, const string& name) {
-    cout << "ݼ: " << name << endl;
-    cout << ": " << data.size() << endl;
+    cout << "数据集: " << name << endl;
+    cout << "样本数量: " << data.size() << endl;
     if (!data.empty()) {
-        cout << ": " << data[0].size() - 1 << endl;
-        cout << ": ";
+        cout << "特征数量: " << data[0].size() - 1 << endl;
+        cout << "类别数量: ";
 
-        // ͳ
+        // 统计类别
         vector<string> classes;
         for (const auto& row : data) {
             string className = row.back();
@@ -166,7 +166,7 @@ void printDatasetInfo(const vector<vector<string>>& data, const string& name) {
     cout << "------------------------" << endl;
 }
 
-// Է
+// 测试分类器性能
 void testClassifier(ID3& classifier, const vector<vector<string>>& testData) {
     if (testData.empty()) return;
 
@@ -174,109 +174,109 @@ void testClassifier(ID3& classifier, const vector<vector<string>>& testData) {
     int total = testData.size();
 
     for (const auto& sample : testData) {
-        // ׼ȥǩ
+        // 准备特征向量（去掉类别标签）
         vector<string> features(sample.begin(), sample.end() - 1);
         string trueLabel = sample.back();
 
-        // Ԥ
+        // 预测
         string predictedLabel = classifier.predict(features);
 
-        // Ƿȷ
+        // 检查是否正确
         if (predictedLabel == trueLabel) {
             correct++;
         }
     }
 
     double accuracy = static_cast<double>(correct) / total * 100;
-    cout << "Խ:" << endl;
-    cout << "  : " << total << endl;
-    cout << "  ȷ: " << correct << endl;
-    cout << "  ׼ȷ: " << accuracy << "%" << endl;
+    cout << "测试结果:" << endl;
+    cout << "  总样本数: " << total << endl;
+    cout << "  正确分类: " << correct << endl;
+    cout << "  准确率: " << accuracy << "%" << endl;
 }
 
 int main() {
-    // 1. ȡIrisݼ
-    cout << "ڶȡIrisݼ..." << endl;
+    // 1. 读取Iris数据集
+    cout << "正在读取Iris数据集..." << endl;
     vector<vector<string>> rawData = readCSV("iris.data");
 
     if (rawData.empty()) {
-        cerr << ": ޷ȡݼݼΪգ" << endl;
-        cerr << "ȷiris.dataļλڵǰĿ¼¡" << endl;
+        cerr << "错误: 无法读取数据集或数据集为空！" << endl;
+        cerr << "请确保iris.data文件位于当前目录下。" << endl;
         return 1;
     }
 
-    cout << "ɹȡ " << rawData.size() << " " << endl;
+    cout << "成功读取 " << rawData.size() << " 条数据" << endl;
 
-    // 2. Ԥݣɢ
-    cout << "\nԤݣɢ..." << endl;
+    // 2. 预处理数据（离散化连续特征）
+    cout << "\n正在预处理数据（离散化连续特征）..." << endl;
     vector<vector<string>> dataset = prepareDataset(rawData);
 
     if (dataset.empty()) {
-        cerr << ": Ԥʧܣ" << endl;
+        cerr << "错误: 数据预处理失败！" << endl;
         return 1;
     }
 
-    // 3. ѵͲԼ
-    cout << "\nѵͲԼ80%/20%..." << endl;
+    // 3. 划分训练集和测试集
+    cout << "\n划分训练集和测试集（80%/20%）..." << endl;
     vector<vector<string>> trainData, testData;
     splitDataset(dataset, trainData, testData, 0.8);
 
-    // 4. ӡݼϢ
-    printDatasetInfo(trainData, "ѵ");
-    printDatasetInfo(testData, "Լ");
+    // 4. 打印数据集信息
+    printDatasetInfo(trainData, "训练集");
+    printDatasetInfo(testData, "测试集");
 
-    // 5. ׼ѵݣͱǩֿ
+    // 5. 准备训练数据（特征和标签分开）
     vector<vector<string>> trainFeatures;
     vector<string> trainLabels;
 
     for (const auto& sample : trainData) {
-        // ȥһԪأ
+        // 特征（去掉最后一个元素）
         vector<string> features(sample.begin(), sample.end() - 1);
         trainFeatures.push_back(features);
 
-        // ǩһԪأ
+        // 标签（最后一个元素）
         trainLabels.push_back(sample.back());
     }
 
-    // 6. ѵID3
-    cout << "\nѵID3..." << endl;
+    // 6. 创建并训练ID3决策树
+    cout << "\n正在训练ID3决策树..." << endl;
     ID3 classifier;
 
-    // ƣIrisݼ
+    // 定义特征名称（根据Iris数据集）
     vector<string> featureNames = {
         "sepal_length", "sepal_width", "petal_length", "petal_width"
     };
 
-    // ѵ
+    // 训练分类器
     classifier.train(trainFeatures, trainLabels, featureNames);
 
-    // 7. ʾṹѡ
-    cout << "\nṹ:" << endl;
+    // 7. 显示决策树结构（可选）
+    cout << "\n决策树结构:" << endl;
     classifier.printTree();
 
-    // 8. ڲԼ
-    cout << "\nڲԼ..." << endl;
+    // 8. 在测试集上评估分类器
+    cout << "\n在测试集上评估分类器性能..." << endl;
     testClassifier(classifier, testData);
 
-    // 9. ʾз
-    cout << "\nʾԤ:" << endl;
+    // 9. 示例：对新样本进行分类
+    cout << "\n示例预测:" << endl;
 
-    // ʾ1͵Iris-setosa
+    // 示例1：典型的Iris-setosa
     vector<string> sample1 = { "bin_0", "bin_1", "bin_0", "bin_0" };
-    cout << "1 [̻, л, ̻, խ]: "
+    cout << "样本1 [短花萼, 中花萼宽, 短花瓣, 窄花瓣]: "
         << classifier.predict(sample1) << endl;
 
-    // ʾ2͵Iris-versicolor
+    // 示例2：典型的Iris-versicolor
     vector<string> sample2 = { "bin_1", "bin_1", "bin_1", "bin_1" };
-    cout << "2 [л, л, л, л]: "
+    cout << "样本2 [中花萼, 中花萼宽, 中花瓣, 中花瓣宽]: "
         << classifier.predict(sample2) << endl;
 
-    // ʾ3͵Iris-virginica
+    // 示例3：典型的Iris-virginica
     vector<string> sample3 = { "bin_2", "bin_1", "bin_2", "bin_2" };
-    cout << "3 [, л, , ]: "
+    cout << "样本3 [长花萼, 中花萼宽, 长花瓣, 宽花瓣]: "
         << classifier.predict(sample3) << endl;
 
-    cout << "\nID3ɣ" << endl;
+    cout << "\nID3分类完成！" << endl;
 
     return 0;
 }
\ No newline at end of file